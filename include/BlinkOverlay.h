@@ -1,7 +1,8 @@
 // --- file: BlinkOverlay.h
 #pragma once
-#include <Arduino.h>
+#include "Hal.h"
 #include "LedSet.h"
+#include "WakeScheduler.h"
 
 class BlinkOverlay {
 public:
@@ -16,15 +17,27 @@ public:
     phaseStart = now;
   }
 
-    void stop(LedSet* blinkSet = nullptr) {
+    // Set = LedSet of StaticLedSet<...>
+    template <class Set = LedSet>
+    void stop(Set* blinkSet = nullptr) {
         enabled = false;
         if (blinkSet) blinkSet->setAllScaledMasked(0); // zet blink-kanalen uit
     }
 
     bool isEnabled() const { return enabled; }
+
+    // ms tot de volgende aan/uit-flank (WakeScheduler)
+    uint32_t nextWakeIn(uint32_t now) const {
+        if (!enabled) return WakeScheduler::kForever;
+        uint32_t p = period < 10 ? 10 : period;
+        uint32_t t = (now - phaseStart) % p;
+        uint32_t onTime = (uint32_t)((p * (uint32_t)duty) / 100u);
+        return t < onTime ? onTime - t : p - t;
+    }
     
     // NB: stuur hier de BLINK-set in; NIET de actieve thunder/day-set
-    void update(uint32_t now, LedSet& blinkSet) {
+    template <class Set>
+    void update(uint32_t now, Set& blinkSet) {
         if (!enabled) return;
         if (period < 10) period = 10;
 
@@ -1,22 +1,55 @@
 // --- file: Button.h
 #pragma once
-#include <Arduino.h>
+#include "Hal.h"
+#include "SpscRing.h"
 
-constexpr uint32_t BTN_DEBOUNCE_MS = 50; // debounce delay, typically 25 ms - 50 ms
+constexpr uint32_t BTN_DEBOUNCE_MS = 50;   // debounce delay, typically 25 ms - 50 ms
+constexpr uint32_t BTN_LONG_MS = 600;      // vasthouden tot LongPress
+constexpr uint32_t BTN_REPEAT_MS = 150;    // daarna elke ... een Repeat (alleen knoppen met autoRepeat)
 
+// Knopgebeurtenis met het tijdstip van de flank (Press/Release) of van het vasthouden (LongPress/Repeat)
+struct ButtonEvent
+{
+    enum Kind : uint8_t { Press, Release, LongPress, Repeat };
+    Kind kind;
+    uint32_t ms;
+};
+
+// Interrupt-gedreven knop: niemand pollt de pin.
+//  - pin-ISR (elke flank): noteert het tijdstip en armt een one-shot timer op 1 ms;
+//  - timer-callback (FreeRTOS timer-taak): leest de pin, debounce (flank direct door, daarna
+//    BTN_DEBOUNCE_MS lockout), long-press en auto-repeat; zet gebeurtenissen in de queue en wekt de taak
+//    die begin() aanriep. Hij armt zichzelf opnieuw zolang er nog iets te beslissen valt.
+// De taak haalt alles op met pop(); elke druk komt er precies één keer uit, ook als de taak even
+// niet kijkt (tot 16 gebeurtenissen; daarboven telt dropped()).
 struct Button
 {
     int pin;
     bool activeLow;
-    bool state;
-    bool lastState;
-    bool pressedEvent;
-    uint32_t lastChangeMs;
+    bool autoRepeat;
 
-    Button(int p, bool aLow = true);
-    void begin();
+    Button(int p, bool aLow = true, bool repeat = false);
+    void begin();                       // vanuit de taak die de gebeurtenissen verwerkt
     bool readRaw() const;
-    void update(uint32_t now);
-    bool consumePressed();
-};
+    bool pop(ButtonEvent& ev) { return events.pop(ev); }
+    bool isPressed() const { return state; }    // laatst gemelde toestand (timer-taak)
+    uint32_t dropped() const { return droppedEvents; }
+
+private:
+    SpscRing<ButtonEvent, 16> events;   // producent: timer-callback, consument: taak
+    Hal::TimerRef timer = nullptr;
+    Hal::TaskRef task = nullptr;
+    volatile uint32_t edgeMs = 0;       // laatste flank (ISR)
+    volatile uint32_t edges = 0;        // flanken geteld door de ISR
+    bool state = false;                 // gedebouncede toestand (alleen timer-callback)
+    uint32_t changeMs = 0;              // laatst geaccepteerde flank: begin van de lockout
+    uint32_t holdAtMs = 0;              // volgende LongPress/Repeat zolang ingedrukt
+    bool holdPending = false;
+    bool longSent = false;
+    uint32_t droppedEvents = 0;
 
+    static void onEdgeIsr(void* self);
+    static void onTimer(void* self);
+    void settle(uint32_t now);
+    void push(ButtonEvent::Kind kind, uint32_t ms);
+};
@@ -0,0 +1,218 @@
+// --- file: Compositor.h
+#pragma once
+#include "Hal.h"
+#include "LedPwm.h"
+#include "Perceptual.h"
+#include "WakeScheduler.h"
+
+// Frame-based compositing: programma's en overlays schrijven niet meer direct naar de LEDC,
+// maar in een eigen FrameLayer. De Compositor mengt alle lagen (onder -> boven) één keer per
+// frame tot één duty-buffer en commit die naar de LedPwmChannels.
+// Lagen werken in perceptuele helderheid; bij commit() gaat het frame door de L*-tabel naar
+// lineaire duty (Config::LED_PERCEPTUAL, uit te zetten met setPerceptual(false)).
+// Ramps: FrameLayer::fade() zet een lineaire overgang op een kanaal; commit() mengt die per frame.
+// (Niet naar de LEDC-fade-unit: onder Arduino-core 2.x is een lopende ramp niet te stoppen en
+// wacht elke ledcWrite erop, core 3.x heeft geen ledcSetup meer, en het scheelde geen meetbare CPU.)
+
+enum class BlendMode : uint8_t {
+    Replace,  // laag overschrijft wat eronder ligt
+    Max,      // hoogste waarde wint
+    Add,      // optellen, verzadigd op maxDuty
+    Multiply  // onderliggende waarde * (laag / maxDuty), bv. dimmen
+};
+
+class FrameLayer {
+public:
+    FrameLayer(int count, uint16_t maxDuty, BlendMode mode = BlendMode::Replace)
+        : n(count), maxv(maxDuty), blend(mode),
+          duty(new uint16_t[count > 0 ? count : 1]), owned(new bool[count > 0 ? count : 1]),
+          ramp(new Ramp[count > 0 ? count : 1]) {
+        clear();
+    }
+    ~FrameLayer() { delete[] duty; delete[] owned; delete[] ramp; }
+    FrameLayer(const FrameLayer&) = delete;
+    FrameLayer& operator=(const FrameLayer&) = delete;
+
+    // Schrijf één kanaal; vanaf nu 'bezit' deze laag het kanaal en doet het mee in de mix
+    void set(int i, uint16_t d) {
+        if (i < 0 || i >= n) return;
+        duty[i] = d > maxv ? maxv : d;
+        owned[i] = true;
+        ramp[i].ms = 0;
+    }
+    // Lineair van de huidige waarde naar d in ms (0 = direct, zoals set()); een set() breekt de ramp af
+    void fade(int i, uint16_t d, uint32_t ms, uint32_t now) {
+        if (i < 0 || i >= n) return;
+        if (ms == 0) { set(i, d); return; }
+        uint16_t from = owned[i] ? valueAt(i, now) : 0;
+        duty[i] = d > maxv ? maxv : d;
+        owned[i] = true;
+        ramp[i] = { from, now, ms };
+    }
+    // Kanaal weer vrijgeven: de laag laat het kanaal ongemoeid
+    void release(int i) { if (i >= 0 && i < n) { owned[i] = false; ramp[i].ms = 0; } }
+    void clear() { for (int i = 0; i < n; ++i) { duty[i] = 0; owned[i] = false; ramp[i] = Ramp(); } }
+
+    // eindwaarde (bij een ramp: het doel); valueAt() geeft de waarde op een tijdstip
+    uint16_t get(int i) const { return (i >= 0 && i < n) ? duty[i] : 0; }
+    uint16_t valueAt(int i, uint32_t now) const { return (i >= 0 && i < n) ? sample(i, now) : 0; }
+    bool owns(int i) const { return i >= 0 && i < n && owned[i]; }
+    bool fading(int i, uint32_t now) const { return i >= 0 && i < n && rampActive(i, now); }
+
+    // Dekking van de hele laag (Q16, kOpaque = vol). Onder kOpaque telt een kanaal dat de laag niet
+    // bezit als 0, zodat een laag die uitfadet ook 'zijn' lege kanalen meeneemt (crossfades).
+    static constexpr uint16_t kOpaque = 0xFFFF;
+    void setOpacity(uint16_t q16) { opacity = q16; }
+    uint16_t getOpacity() const { return opacity; }
+
+    void setMode(BlendMode m) { blend = m; }
+    BlendMode mode() const { return blend; }
+    void setEnabled(bool e) { enabled = e; }
+    bool isEnabled() const { return enabled; }
+
+    int size() const { return n; }
+    uint16_t maxDuty() const { return maxv; }
+
+private:
+    int n;
+    uint16_t maxv;
+    BlendMode blend;
+    bool enabled = true;
+    uint16_t opacity = kOpaque;
+    friend class Compositor;     // commit() gebruikt de ongecontroleerde varianten hieronder
+
+    struct Ramp { uint16_t from; uint32_t start; uint32_t ms; }; // ms 0 = geen ramp
+
+    bool rampActive(int i, uint32_t now) const { return ramp[i].ms && (now - ramp[i].start) < ramp[i].ms; }
+    uint16_t sample(int i, uint32_t now) const {
+        const Ramp& r = ramp[i];
+        uint32_t t = now - r.start;
+        if (r.ms == 0 || t >= r.ms) return duty[i];
+        // ramps tot ~32 s passen in 32 bits: geen 64-bits deling (op de ESP32 een libcall)
+        int32_t d = (int32_t)duty[i] - r.from;
+        if (t < 0x8000u) return (uint16_t)(r.from + d * (int32_t)t / (int32_t)r.ms);
+        return (uint16_t)((int64_t)r.from + (int64_t)d * (int64_t)t / r.ms);
+    }
+
+    uint16_t* duty;
+    bool* owned;
+    Ramp* ramp;
+};
+
+class Compositor {
+public:
+    static constexpr int kMaxLayers = 8;
+
+    Compositor(LedPwmChannel** channels, int count)
+        : chans(channels), n(count), frame(new uint16_t[count > 0 ? count : 1]) {
+        for (int i = 0; i < n; ++i) frame[i] = 0;
+        // elke driver (LEDC, PCA9685-borden) één keer per frame flushen
+        for (int i = 0; i < n; ++i) {
+            PwmDriver* d = &chans[i]->driver();
+            bool known = false;
+            for (int k = 0; k < driverCount; ++k) known |= drivers[k] == d;
+            if (!known && driverCount < kMaxDrivers) drivers[driverCount++] = d;
+        }
+    }
+    ~Compositor() { delete[] frame; }
+    Compositor(const Compositor&) = delete;
+    Compositor& operator=(const Compositor&) = delete;
+
+    // Lagen worden in volgorde van toevoegen gemengd: eerste = onderste
+    bool addLayer(FrameLayer* layer) {
+        if (!layer || layerCount >= kMaxLayers) return false;
+        layers[layerCount++] = layer;
+        return true;
+    }
+    // positie in de mix (0 = onderste), -1 als de laag niet is toegevoegd
+    int layerIndex(const FrameLayer* layer) const {
+        for (int l = 0; l < layerCount; ++l)
+            if (layers[l] == layer) return l;
+        return -1;
+    }
+
+    // Meng alle actieve lagen en schrijf het resultaat één keer naar de kanalen
+    void commit() { commit(Hal::millis()); }
+    void commit(uint32_t now) {
+        const uint16_t maxv = maxDuty();
+        for (int i = 0; i < n; ++i) {
+            uint32_t out = 0;
+            for (int l = 0; l < layerCount; ++l) {
+                const FrameLayer* L = layers[l];
+                if (!L->enabled || i >= L->n) continue;
+                if (L->opacity == FrameLayer::kOpaque) {
+                    if (!L->owned[i]) continue;
+                    out = blend(L->blend, out, L->sample(i, now), maxv);
+                } else {
+                    out = blendPartial(L->blend, out, L->owned[i] ? L->sample(i, now) : 0, L->opacity, maxv);
+                }
+            }
+            frame[i] = (uint16_t)out;
+            chans[i]->setDuty(output(frame[i], maxv));
+            chans[i]->commit();
+        }
+        for (int k = 0; k < driverCount; ++k) drivers[k]->flush(); // bv. één I2C-burst per PCA9685
+        ++frames;
+    }
+
+    // ms tot de volgende commit() iets te schrijven heeft (WakeScheduler): een lopende ramp moet elk
+    // frame bijgewerkt worden, de rest verandert alleen via de lagen zelf.
+    // Hetzelfde voor een driver met een frame dat nog niet weg kon (Ws2812Strip).
+    static constexpr uint32_t kSoftRampFrameMs = 1;
+    uint32_t nextWakeIn(uint32_t now) const {
+        for (int k = 0; k < driverCount; ++k)
+            if (drivers[k]->pending()) return kSoftRampFrameMs; // frame wacht op een vrije draad
+        for (int l = 0; l < layerCount; ++l) {
+            const FrameLayer* L = layers[l];
+            if (!L->enabled) continue;
+            int m = L->n < n ? L->n : n;
+            for (int i = 0; i < m; ++i)
+                if (L->owned[i] && L->rampActive(i, now)) return kSoftRampFrameMs;
+        }
+        return WakeScheduler::kForever;
+    }
+
+    void setPerceptual(bool on) { perceptual = on; }
+    bool isPerceptual() const { return perceptual; }
+
+    // gemengde waarde vóór de L*-omzetting (perceptueel); de echte duty staat in het kanaal
+    uint16_t frameDuty(int i) const { return (i >= 0 && i < n) ? frame[i] : 0; }
+    uint32_t frameCount() const { return frames; }
+    int size() const { return n; }
+    uint16_t maxDuty() const { return n > 0 ? chans[0]->maxDuty() : 4095; }
+
+private:
+    LedPwmChannel** chans;
+    int n;
+    uint16_t* frame;            // resultaat van de laatste commit()
+    FrameLayer* layers[kMaxLayers] = {nullptr};
+    int layerCount = 0;
+    uint32_t frames = 0;
+    bool perceptual = Config::LED_PERCEPTUAL;
+    static constexpr int kMaxDrivers = 4;
+    PwmDriver* drivers[kMaxDrivers] = {nullptr};
+    int driverCount = 0;
+
+    uint16_t output(uint16_t v, uint16_t maxv) const { return perceptual ? Perceptual::toDuty(v, maxv) : v; }
+
+    // laag met dekking op (Q16): het effect van de laag schuift van 'niets' (0) naar blend() (kOpaque)
+    static uint32_t blendPartial(BlendMode m, uint32_t below, uint32_t v, uint32_t op, uint16_t maxv) {
+        switch (m) {
+            case BlendMode::Replace:  return (uint32_t)((int64_t)below + (((int64_t)v - (int64_t)below) * op >> 16));
+            case BlendMode::Max:      { uint32_t w = (v * op) >> 16; return w > below ? w : below; }
+            case BlendMode::Add:      { uint32_t s = below + ((v * op) >> 16); return s > maxv ? maxv : s; }
+            case BlendMode::Multiply: { uint32_t f = maxv - (((maxv - v) * op) >> 16); return maxv ? (below * f) / maxv : 0; }
+        }
+        return below;
+    }
+
+    static uint32_t blend(BlendMode m, uint32_t below, uint32_t v, uint16_t maxv) {
+        switch (m) {
+            case BlendMode::Replace:  return v;
+            case BlendMode::Max:      return v > below ? v : below;
+            case BlendMode::Add:      { uint32_t s = below + v; return s > maxv ? maxv : s; }
+            case BlendMode::Multiply: return maxv ? (below * v) / maxv : 0;
+        }
+        return v;
+    }
+};
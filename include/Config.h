@@ -1,6 +1,6 @@
 // --- file: Config.h
 #pragma once    // include guard
-#include <Arduino.h>
+#include "Hal.h"
 
 // Centrale projectconfiguratie
 namespace Config {
@@ -20,6 +20,11 @@ namespace Config {
 
     constexpr int PIN_BUSY = 4; // SV5W BUSY (actief LOW)
 
+    // === Audio-sync (cue-tijdlijnen, zie ThunderCues.h) ===
+    constexpr uint32_t AUDIO_SYNC_OFFSET_MS = 0;   // correctie cue-tijd t.o.v. BUSY-flank (+ = later flitsen)
+    constexpr uint32_t AUDIO_START_LATENCY_MS = 30; // play-frame verstuurd -> audio hoorbaar (als BUSY al actief bleef)
+    constexpr uint32_t CUE_PREGLOW_MS = 20;        // preglow vóór de flits; de burst start zoveel eerder
+
     // === Knoppen ===
     constexpr int PIN_BTN_NEXT = 12; // active LOW, interne pull-up
     constexpr int PIN_BTN_PREV = 14; // active LOW, interne pull-up
@@ -38,10 +43,25 @@ namespace Config {
 
     // === Scenario-profielen ===
     // === LED-set per scenario ===
-    constexpr float LEDSET_THUNDER_WEIGHTS[LED_COUNT] = { 1.00f, 0.50f, 0.20f, 0.00f };
-    constexpr float LEDSET_DAY_WEIGHTS[LED_COUNT]     = { 0.35f, 0.15f, 0.02f, 0.00f };
+    // inline: één object voor alle vertaaleenheden, zodat ze als template-argument bruikbaar zijn (StaticLedSet)
+    inline constexpr float LEDSET_THUNDER_WEIGHTS[LED_COUNT] = { 1.00f, 0.50f, 0.20f, 0.00f };
+    inline constexpr float LEDSET_DAY_WEIGHTS[LED_COUNT]     = { 0.35f, 0.15f, 0.02f, 0.00f };
     // Knipperlicht: kies expliciet welke kanalen mogen knipperen (1.00f = ja, 0.00f = negeren)
-    constexpr float LEDSET_BLINK_WEIGHTS[LED_COUNT]   = { 0.0f, 0.0f, 0.0f, 1.0f };
+    inline constexpr float LEDSET_BLINK_WEIGHTS[LED_COUNT]   = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+    // === Ruimtelijk onweer (StrikeField.h) ===
+    // Positie per LED-kanaal in cm (x/y horizontaal, z hoogte); pas aan naar je opstelling. Elke burst
+    // kiest een inslagpunt boven de LED's: dichtbij = eerst en het felst, ver weg = later en zwakker.
+    struct LedPos { float x, y, z; };
+    inline constexpr LedPos LED_POS[LED_COUNT] = {
+        {  0.0f,  0.0f, 30.0f },   // LED 0: wolk links
+        { 40.0f, 10.0f, 30.0f },   // LED 1: wolk midden
+        { 80.0f,  0.0f, 30.0f },   // LED 2: wolk rechts
+        { 60.0f, 30.0f,  5.0f },   // LED 3: knipperlicht (laag, achterin)
+    };
+    constexpr float STRIKE_HEIGHT_CM = 50.0f; // inslagpunten zoveel boven de hoogste LED
+    constexpr float STRIKE_SPREAD_CM = 100.0f; // zoveel verder dan het dichtste kanaal: volle vertraging en afzwakking
+    constexpr float STRIKE_FALLOFF = 0.4f;    // kanaal op STRIKE_SPREAD_CM of verder krijgt (1 - dit) van de flits
 
     /*
     Idee: koppel elke LED-index aan een fysieke kleur (bijv. LED 0 = koud wit, LED 1 = warm wit, LED 2 = blauw, etc.).
@@ -51,4 +71,47 @@ namespace Config {
     // === LEDC instellingen ===
     constexpr uint32_t LEDC_FREQ = 3000; // 3 kHz (pas aan)
     constexpr uint8_t LEDC_RES_BITS = 12; // 0..4095 (pas aan)
+    constexpr bool LED_PERCEPTUAL = true;  // true = duty's van programma's zijn waargenomen helderheid (CIE L*), zie Perceptual.h
+
+    // === PCA9685 (I2C, 16 x 12-bit PWM per bord) ===
+    // true = LED i is uitgang i van de PCA9685-borden i.p.v. LEDC-kanaal LEDC_CH[i] (zie Pca9685.h).
+    // Per frame gaat er één I2C-burst per bord met gewijzigde uitgangen: een vol frame van 64 kanalen
+    // (4 borden, 4 x 66 bytes) kost ~2.4 ms bij 1 MHz, de 4 kanalen hier ~0.2 ms.
+    constexpr bool LED_USE_PCA9685 = false;
+    constexpr int PCA9685_BOARDS = 1;           // 1..4, adressen PCA9685_ADDR, +1, ...
+    constexpr uint8_t PCA9685_ADDR = 0x40;      // A0..A5 laag
+    constexpr uint32_t PCA9685_PWM_FREQ = 1000; // 24..1526 Hz, geldt per bord voor alle uitgangen
+    constexpr int I2C_SDA_PIN = 23;             // 21 is de lantaarnpin
+    constexpr int I2C_SCL_PIN = 22;
+    constexpr uint32_t I2C_FREQ = 1000000;      // Fast-mode Plus; 400000 bij lange draden
+
+    // === WS2812-pixelstrip (RMT, optioneel) ===
+    // Naast de kanalen hierboven: één onweer-kanaal per pixel, dat de bursts van de actieve thunder-modus
+    // volgt. Een frame kost 30 us per pixel op de draad (+300 us reset); de render-taak wacht daar niet op.
+    constexpr int WS2812_PIXELS = 0;            // 0 = geen strip
+    constexpr int WS2812_PIN = 13;
+    constexpr int WS2812_RMT_CH = 0;            // 0..7; met 2 geheugenblokken ook RMT-kanaal 1 bezet
+    constexpr float WS2812_PITCH_CM = 1.67f;    // pixelafstand (60/m); de strip ligt als rechte lijn in StrikeField
+    inline constexpr uint8_t WS2812_TINT[3] = { 190, 200, 255 }; // R, G, B van een volle flits (blauwwit)
+
+    // === Moduswissel ===
+    constexpr uint32_t MODE_CROSSFADE_MS = 2000; // oud en nieuw programma mengen; 0 = direct wisselen
+
+    // === Willekeur ===
+    // Master-seed voor de PRNG's van programma's en SV5W (Rng.h). 0 = bij elke start een nieuwe uit de
+    // hardware-RNG; hij wordt gelogd, zodat een storing met 'program --seed <seed>' na te spelen is.
+    constexpr uint64_t RNG_SEED = 0;
+
+    // === Energie ===
+    constexpr bool LOOP_SLEEP = true; // taken slapen tot hun eerstvolgende deadline (WakeScheduler.h); false = vaste frame-/pollrate
+
+    // === Taken (dual-core) ===
+    // Render-taak: programma's, overlays, compositor. I/O-taak: knoppen, serial, SV5W, BUSY.
+    constexpr int RENDER_CORE = 1;              // APP_CPU
+    constexpr int IO_CORE = 0;                  // PRO_CPU
+    constexpr uint32_t RENDER_TASK_PRIO = 5;    // boven de I/O-taak en de Arduino loop-taak (1)
+    constexpr uint32_t IO_TASK_PRIO = 2;
+    constexpr uint32_t RENDER_TASK_STACK = 4096; // bytes
+    constexpr uint32_t IO_TASK_STACK = 6144;     // printf's in stats/BUSY-log
+    constexpr uint32_t RENDER_FRAME_MS = 1;     // max. framerate van de render-taak (1 kHz, zoals de oude loop)
 }
\ No newline at end of file
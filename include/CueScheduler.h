@@ -0,0 +1,89 @@
+// --- file: CueScheduler.h
+#pragma once
+#include "Hal.h"
+#include "Config.h"
+#include "ThunderCues.h"
+#include "LightProgram.h"
+#include "WakeScheduler.h"
+
+// Speelt een cue-tijdlijn af op ProgThunder, verankerd aan de start van de audio:
+//  - arm(track)      : bij moduswissel, tijdlijn van de gekozen track (nullptr = geen sync)
+//  - playSent(now)   : het play-frame is echt over de UART gegaan (SV5W onSent-hook)
+//  - busyEdge(...)   : gedebouncede BUSY-flank uit main.cpp; actief = audio loopt -> anker
+// Blijft BUSY actief (track-wissel zonder STOP ertussen), dan wordt het anker
+// play-frame + AUDIO_START_LATENCY_MS. Elke burst start CUE_PREGLOW_MS vóór de klap,
+// zodat de eerste subflits op de klap valt.
+class CueScheduler {
+public:
+    static constexpr uint32_t kBusyWaitMs = 150;   // wachten op een BUSY-flank na het play-frame
+    static constexpr uint32_t kLateMs = 100;       // cue die zoveel te laat is wordt overgeslagen
+
+    void arm(const CueTrack* t) {
+        track = t;
+        state = t ? Armed : Off;
+        next = 0;
+    }
+
+    void playSent(uint32_t now) {
+        if (state == Off) return;
+        state = WaitBusy;
+        sentMs = now;
+        next = 0;
+    }
+
+    void busyEdge(bool active, uint32_t edgeMs) {
+        if (active && (state == Armed || state == WaitBusy)) begin(edgeMs);
+        else if (!active && state == Running) state = Armed; // track klaar: wacht op een volgende start
+    }
+
+    void update(uint32_t now, bool busyActive, ProgThunder& prog) {
+        if (state == WaitBusy && busyActive && (now - sentMs) >= kBusyWaitMs)
+            begin(sentMs + Config::AUDIO_START_LATENCY_MS);
+
+        prog.setCueSync(state == Running);
+        if (state != Running) return;
+
+        while (next < track->count) {
+            const ThunderCue& c = track->cues[next];
+            uint32_t at = nextAtMs + c.deltaMs;
+            if ((int32_t)(now + Config::CUE_PREGLOW_MS - at) < 0) break; // nog niet
+            ++next;
+            nextAtMs = at;
+            if ((int32_t)(now - at) > (int32_t)kLateMs) { ++late; continue; }
+            if (c.intensity == 0) continue; // alleen een tijdsstap
+            uint32_t pre = (int32_t)(at - now) > 0 ? at - now : 1;
+            prog.triggerBurst(now, c.intensity, c.subs, pre);
+            ++fired;
+        }
+        if (next >= track->count) state = Done;
+    }
+
+    // ms tot de volgende cue (minus preglow) of het einde van het wachten op BUSY (WakeScheduler)
+    uint32_t nextWakeIn(uint32_t now) const {
+        if (state == WaitBusy) {
+            // na het wachtvenster start alleen nog een BUSY-flank de tijdlijn, en die wekt zelf
+            uint32_t d = WakeScheduler::until(now, sentMs + kBusyWaitMs);
+            return d ? d : WakeScheduler::kForever;
+        }
+        if (state != Running || next >= track->count) return WakeScheduler::kForever;
+        return WakeScheduler::until(now + Config::CUE_PREGLOW_MS, nextAtMs + track->cues[next].deltaMs);
+    }
+
+    bool running() const { return state == Running; }
+    uint32_t cuesFired() const { return fired; }
+    uint32_t cuesLate() const { return late; }
+
+private:
+    enum State : uint8_t { Off, Armed, WaitBusy, Running, Done } state = Off;
+    const CueTrack* track = nullptr;
+    uint16_t next = 0;          // index van de volgende cue
+    uint32_t nextAtMs = 0;      // tijdstip van de laatst verwerkte cue (som van deltas)
+    uint32_t sentMs = 0;
+    uint32_t fired = 0, late = 0;
+
+    void begin(uint32_t anchorMs) {
+        state = Running;
+        next = 0;
+        nextAtMs = anchorMs + Config::AUDIO_SYNC_OFFSET_MS;
+    }
+};
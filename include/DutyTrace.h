@@ -0,0 +1,158 @@
+// --- file: DutyTrace.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Compact binair spoor van de licht-uitvoer: wat LedPwmChannel echt naar zijn driver stuurt
+// (write bij commit()). Bedoeld om twee versies van de engine
+// te vergelijken (golden traces, zie src/native/GoldenTrace.cpp) en om een storing op te nemen.
+//
+// Formaat (little endian, varints = LEB128, zigzag voor verschillen):
+//   "LTRC" versie(1)  varint64 seed  varint startMs
+//   per gebeurtenis: varint tag = (dtMs << 8) | kanaal(0..255)
+//                    zigzag(duty - vorige duty van dat kanaal)
+// Kanaal = traceBase() van de driver + kanaal binnen de driver, zodat LEDC-kanaal 0, PCA9685-uitgang 0
+// en WS2812-pixel 0 niet samenvallen: LEDC 0..15, PCA9685 16..79 (4 borden), WS2812 80..255.
+// Een frame met ongewijzigde duty's kost niets (commit() schrijft dan niet); een typische write is
+// 2-3 bytes, dus uren 1 kHz-storm blijven enkele honderden KB.
+namespace DutyTrace {
+    constexpr uint8_t kMagic[4] = { 'L', 'T', 'R', 'C' };
+    constexpr uint8_t kVersion = 3;    // 3: 8 bits kanaal, per driver een eigen bereik; geen fade-bit meer
+    constexpr int kMaxChannels = 256;
+
+    // eerste spoorkanaal per backend (PwmDriver::traceBase())
+    constexpr int kBaseLedc = 0;
+    constexpr int kBasePca9685 = 16;
+    constexpr int kBaseWs2812 = 80;
+
+    struct Event {
+        uint32_t ms;
+        uint8_t ch;          // PwmDriver::traceBase() + LedPwmChannel::channel()
+        uint16_t duty;
+    };
+
+    inline bool operator==(const Event& a, const Event& b) {
+        return a.ms == b.ms && a.ch == b.ch && a.duty == b.duty;
+    }
+    inline bool operator!=(const Event& a, const Event& b) { return !(a == b); }
+}
+
+// Encoder met een kleine vaste buffer; vol = flush-callback (bestand, RAM-ring, serial, ...)
+class DutyTraceWriter {
+public:
+    using FlushFn = void (*)(const uint8_t* data, size_t n, void* ctx);
+
+    DutyTraceWriter(FlushFn fn, void* ctx) : flushFn(fn), flushCtx(ctx) {}
+    ~DutyTraceWriter() { flush(); }
+    DutyTraceWriter(const DutyTraceWriter&) = delete;
+    DutyTraceWriter& operator=(const DutyTraceWriter&) = delete;
+
+    void begin(uint64_t seed, uint32_t startMs) {
+        len = 0;
+        total = 0;
+        count = 0;
+        droppedCount = 0;
+        lastMs = startMs;
+        for (int i = 0; i < DutyTrace::kMaxChannels; ++i) prev[i] = 0;
+        for (uint8_t b : DutyTrace::kMagic) put(b);
+        put(DutyTrace::kVersion);
+        putVarint(seed);
+        putVarint(startMs);
+    }
+
+    void write(uint32_t ms, int ch, uint16_t duty) {
+        if (ch < 0 || ch >= DutyTrace::kMaxChannels) { ++droppedCount; return; }
+        if (len > sizeof(buf) - 16) flush(); // ruimte voor de grootste gebeurtenis
+        putVarint(((uint64_t)(ms - lastMs) << 8) | (uint32_t)ch);
+        int32_t d = (int32_t)duty - (int32_t)prev[ch];
+        putVarint(((uint32_t)d << 1) ^ (uint32_t)(d >> 31));  // zigzag: kleine +/- verschillen = 1 byte
+        lastMs = ms;
+        prev[ch] = duty;
+        ++count;
+    }
+
+    void flush() {
+        if (len && flushFn) flushFn(buf, len, flushCtx);
+        len = 0;
+    }
+
+    uint64_t bytes() const { return total; }
+    uint32_t events() const { return count; }
+    // gebeurtenissen buiten 0..kMaxChannels-1 (bv. een WS2812-strip met meer dan 176 kanalen): passen
+    // niet in het formaat en staan niet in het spoor; een spoor met dropped() > 0 is onvolledig
+    uint32_t dropped() const { return droppedCount; }
+
+private:
+    FlushFn flushFn;
+    void* flushCtx;
+    uint8_t buf[256];
+    size_t len = 0;
+    uint64_t total = 0;
+    uint32_t count = 0;
+    uint32_t droppedCount = 0;
+    uint32_t lastMs = 0;
+    uint16_t prev[DutyTrace::kMaxChannels] = {};
+
+    void put(uint8_t b) {
+        if (len == sizeof(buf)) flush();
+        buf[len++] = b;
+        ++total;
+    }
+
+    void putVarint(uint64_t v) {
+        while (v >= 0x80) {
+            put((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        put((uint8_t)v);
+    }
+};
+
+// Decoder over een buffer in het geheugen (host)
+class DutyTraceReader {
+public:
+    DutyTraceReader(const uint8_t* data, size_t n) : p(data), end(data + n) {
+        for (uint8_t b : DutyTrace::kMagic)
+            if (p >= end || *p++ != b) { bad = true; return; }
+        if (p >= end || *p++ != DutyTrace::kVersion) { bad = true; return; }
+        uint64_t start = 0;
+        if (!getVarint(seed_) || !getVarint(start)) { bad = true; return; }
+        lastMs = (uint32_t)start;
+    }
+
+    bool valid() const { return !bad; }
+    uint64_t seed() const { return seed_; }
+
+    // false aan het eind of bij een beschadigd/afgekapt spoor (dan is valid() false)
+    bool next(DutyTrace::Event& e) {
+        if (bad || p == end) return false;
+        uint64_t tag = 0, zz = 0;
+        if (!getVarint(tag) || !getVarint(zz)) { bad = true; return false; }
+        e.ch = (uint8_t)(tag & 0xFF);
+        lastMs += (uint32_t)(tag >> 8);
+        int32_t d = (int32_t)((uint32_t)(zz >> 1) ^ (0u - (uint32_t)(zz & 1)));
+        prev[e.ch] = (uint16_t)(prev[e.ch] + d);
+        e.ms = lastMs;
+        e.duty = prev[e.ch];
+        return true;
+    }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+    bool bad = false;
+    uint64_t seed_ = 0;
+    uint32_t lastMs = 0;
+    uint16_t prev[DutyTrace::kMaxChannels] = {};
+
+    bool getVarint(uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) return false;
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,222 @@
+// --- file: Hal.h
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace Hal {
+    // Byte-stream naar een externe module (SV5W). ESP32: UartStream om een HardwareSerial,
+    // native: een gesimuleerde peer zoals de SV5W-mock in src/native/.
+    class ByteStream {
+    public:
+        virtual ~ByteStream() = default;
+        virtual int available() = 0;
+        virtual int read() = 0;              // -1 als er niets is
+        virtual size_t write(uint8_t b) = 0;
+    };
+
+    // I2C-master (PCA9685). ESP32: WireBus om een TwoWire, native: FakeI2cBus in src/native/.
+    class I2cBus {
+    public:
+        virtual ~I2cBus() = default;
+        // één transactie: START, adres+W, n bytes, STOP; false = NACK of busfout
+        virtual bool write(uint8_t addr, const uint8_t* data, size_t n) = 0;
+    };
+
+    // Zender voor een adresseerbare LED-strip (WS2812). ESP32: RmtPixelOut (RMT-peripheral),
+    // native: RmtSink in src/native/. send() start de overdracht en keert direct terug; de bytes
+    // moeten ongewijzigd blijven tot busy() false is (daarom dubbel gebufferd in Ws2812Strip).
+    class PixelOut {
+    public:
+        virtual ~PixelOut() = default;
+        // vorige frame nog op de draad, inclusief de reset-pauze erna
+        virtual bool busy() = 0;
+        // false = nog bezig of zendfout
+        virtual bool send(const uint8_t* data, size_t n) = 0;
+    };
+}
+
+// Dunne hardware-abstractie voor de licht-engine.
+// ESP32 (standaard): alles wordt 1-op-1 doorgegeven aan de Arduino core.
+// Native (-DHAL_NATIVE): virtuele klok, gesimuleerde pinnen en PWM (zie src/native/HalNative.cpp),
+// zodat LightProgram, LedSet, BlinkOverlay, Button en SV5W (via ByteStream) op een Linux-machine draaien.
+
+#ifndef HAL_NATIVE
+
+#include <Arduino.h>
+#include <Wire.h>
+
+namespace Hal {
+    // --- tijd
+    inline uint32_t millis() { return ::millis(); }
+    inline uint32_t micros() { return ::micros(); }
+    inline void delay(uint32_t ms) { ::delay(ms); }
+
+    // --- hardware RNG
+    inline uint32_t random32() { return esp_random(); }
+
+    // --- GPIO
+    inline void pinMode(int pin, uint8_t mode) { ::pinMode(pin, mode); }
+    inline int digitalRead(int pin) { return ::digitalRead(pin); }
+    inline void digitalWrite(int pin, uint8_t level) { ::digitalWrite(pin, level); }
+
+    // --- LEDC PWM
+    inline void pwmSetup(int ch, uint32_t freq, uint8_t resBits) { ledcSetup(ch, freq, resBits); }
+    inline void pwmAttach(int pin, int ch) { ledcAttachPin(pin, ch); }
+    inline void pwmWrite(int ch, uint32_t duty) { ledcWrite(ch, duty); }
+
+    // --- slapen tot een deadline (src/HalEsp32.cpp)
+    // waitUntil() blokkeert de aanroepende taak tot deadlineMs of tot een wake-bron afgaat; de CPU
+    // draait dan de FreeRTOS idle-taak (waiti). Een wake tijdens het werk van de taak blijft staan:
+    // de volgende waitUntil() keert dan direct terug, er gaat dus niets verloren.
+    // Wake-bronnen wekken de taak die ze registreert (wakeOnPin/wakeOnReceive vanuit die taak aanroepen).
+    using TaskRef = void*;                    // FreeRTOS TaskHandle_t
+    TaskRef currentTask();
+    void waitUntil(uint32_t deadlineMs);
+    void wake(TaskRef task);                  // vanuit een andere taak of callback
+    void wakeOnPin(int pin);                  // GPIO-interrupt (CHANGE) als wake-bron
+    void wakeOnReceive(HardwareSerial& port); // UART-event (binnengekomen bytes) als wake-bron
+
+    // --- pin-interrupts en one-shot timers (src/HalEsp32.cpp)
+    // attachPinIsr(): isr(arg) bij elke flank (CHANGE); isr moet IRAM_ATTR zijn en kort blijven.
+    // Timers zijn FreeRTOS software-timers: fn(arg) draait in de timer-taak (geen ISR, dus mag lezen,
+    // in een SpscRing schrijven en wake() aanroepen). Opnieuw armen vervangt de lopende termijn.
+    using TimerRef = void*;
+    void attachPinIsr(int pin, void (*isr)(void*), void* arg);
+    TimerRef timerCreate(const char* name, void (*fn)(void*), void* arg); // eenmalig bij begin()
+    void timerArm(TimerRef t, uint32_t ms);                               // vanuit een taak of de timer zelf
+    void timerArmFromIsr(TimerRef t, uint32_t ms);                        // vanuit een pin-ISR
+
+    // --- debug-uitvoer
+    inline void log(const char* msg) { Serial.println(msg); }
+
+    // --- UART naar externe modules (SV5W)
+    class UartStream : public ByteStream {
+    public:
+        void begin(HardwareSerial& p, uint32_t baud, int rxPin, int txPin) {
+            port = &p;
+            port->begin(baud, SERIAL_8N1, rxPin, txPin);
+        }
+        int available() override { return port ? port->available() : 0; }
+        int read() override { return port ? port->read() : -1; }
+        size_t write(uint8_t b) override { return port ? port->write(b) : 0; }
+
+    private:
+        HardwareSerial* port = nullptr;
+    };
+
+    // --- I2C via de Arduino Wire-driver (blokkeert tot de transactie klaar is)
+    class WireBus : public I2cBus {
+    public:
+        void begin(TwoWire& w, int sdaPin, int sclPin, uint32_t hz) {
+            wire = &w;
+            wire->begin(sdaPin, sclPin, hz);
+        }
+        bool write(uint8_t addr, const uint8_t* data, size_t n) override {
+            if (!wire) return false;
+            wire->beginTransmission(addr);
+            wire->write(data, n);
+            return wire->endTransmission() == 0;
+        }
+
+    private:
+        TwoWire* wire = nullptr;
+    };
+
+    // --- WS2812 via de RMT: de driver zet de bytes in zijn ISR om naar pulsen (translator, zie
+    // HalEsp32.cpp), de CPU wacht niet op de draad
+    class RmtPixelOut : public PixelOut {
+    public:
+        bool begin(int pin, int rmtChannel);
+        bool busy() override;
+        bool send(const uint8_t* data, size_t n) override;
+
+    private:
+        int ch = -1;
+        uint32_t latchUntilUs = 0;
+    };
+}
+
+#else // HAL_NATIVE
+
+#include <alloca.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Minimale Arduino-constanten/macro's die de engine gebruikt
+#ifndef HIGH
+#define HIGH 0x1
+#define LOW  0x0
+#endif
+#ifndef INPUT
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+#endif
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+using std::min;
+using std::max;
+
+namespace Hal {
+    uint32_t millis();
+    uint32_t micros();
+    void delay(uint32_t ms);         // schuift de virtuele klok op
+
+    uint32_t random32();             // deterministische xorshift (zie sim::seedRandom)
+
+    void pinMode(int pin, uint8_t mode);
+    int digitalRead(int pin);
+    void digitalWrite(int pin, uint8_t level);
+
+    void pwmSetup(int ch, uint32_t freq, uint8_t resBits);
+    void pwmAttach(int pin, int ch);
+    void pwmWrite(int ch, uint32_t duty);
+
+    // Slapen tot een deadline: schuift de virtuele klok op naar deadlineMs, of naar de eerste
+    // geplande pinwissel op een wake-pin (sim::schedulePin) als die eerder valt.
+    using TaskRef = void*;           // één 'taak' in de simulator
+    inline TaskRef currentTask() { return nullptr; }
+    void waitUntil(uint32_t deadlineMs);
+    void wake(TaskRef task);         // volgende waitUntil() keert direct terug
+    void wakeOnPin(int pin);
+
+    // Pin-ISR en timers zoals op de ESP32, maar synchroon op de virtuele klok: de ISR draait bij de
+    // (geplande) pinwissel, de timer-callback op zijn tijdstip, beide ook midden in waitUntil().
+    using TimerRef = void*;
+    void attachPinIsr(int pin, void (*isr)(void*), void* arg);
+    TimerRef timerCreate(const char* name, void (*fn)(void*), void* arg); // nullptr = geen vrije timer
+    void timerArm(TimerRef t, uint32_t ms);
+    void timerArmFromIsr(TimerRef t, uint32_t ms);
+
+    void log(const char* msg);
+
+    // Besturing van de simulatie (alleen native)
+    namespace sim {
+        constexpr int kMaxPins = 40;
+        constexpr int kMaxPwm  = 16;
+        constexpr int kMaxTimers = 8;
+
+        void reset();                        // klok op 0, pinnen HIGH (pull-up), PWM op 0, ISR's en timers weg
+        void setMillis(uint32_t ms);
+        void advance(uint32_t ms);
+        void advanceMicros(uint32_t us);
+        uint64_t micros64();                 // virtuele tijd zonder 32-bit wrap (voor simulatoren)
+        void setPin(int pin, int level);     // extern aangestuurde ingang (knop, BUSY)
+        bool schedulePin(int pin, int level, uint64_t atUs); // pinwissel op een virtueel tijdstip
+        int pinLevel(int pin);               // laatst geschreven/ingestelde niveau
+        uint32_t pwmDuty(int ch);
+        uint32_t pwmWrites(int ch);          // aantal ledcWrite-aanroepen per kanaal
+        uint32_t timerFires();               // aantal timer-callbacks sinds reset()
+        void seedRandom(uint64_t seed);
+        void setLogEnabled(bool enable);
+    }
+}
+
+#endif // HAL_NATIVE
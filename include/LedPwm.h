@@ -1,19 +1,61 @@
 #pragma once
-#include <Arduino.h>
+#include "Hal.h"
+#include "DutyTrace.h"
+
+// Uitvoer achter een LedPwmChannel: de on-chip LEDC (standaard) of bv. PCA9685-borden via I2C.
+// write() mag bufferen; flush() aan het eind van elk frame (Compositor::commit) stuurt alles weg.
+class PwmDriver
+{
+public:
+    virtual ~PwmDriver() = default;
+    virtual void setup(int ch, int pin, uint32_t freq, uint8_t resBits) = 0;
+    virtual void write(int ch, uint32_t duty) = 0;
+    virtual void flush() {}
+    // nog iets dat een volgende flush() moet wegsturen (bv. de draad was bezig)
+    virtual bool pending() const { return false; }
+    // eerste kanaalnummer van deze driver in een DutyTrace (per backend een eigen bereik)
+    virtual int traceBase() const { return DutyTrace::kBaseLedc; }
+};
+
+// ESP32 LEDC: elke write gaat direct naar het kanaal. Ramps schrijft de Compositor per frame: de
+// LEDC-fade-unit is onder Arduino-core 2.x (IDF 4.4) niet te stoppen (een ledcWrite() wacht dan op
+// de lopende ramp), en core 3.x, waar het wel kan, heeft de ledcSetup/ledcAttachPin-API niet meer.
+class LedcDriver : public PwmDriver
+{
+public:
+    static LedcDriver& instance() { static LedcDriver d; return d; }
+    void setup(int ch, int pin, uint32_t freq, uint8_t resBits) override {
+        Hal::pwmSetup(ch, freq, resBits);
+        Hal::pwmAttach(pin, ch);
+    }
+    void write(int ch, uint32_t duty) override { Hal::pwmWrite(ch, duty); }
+};
 
 // LED PWM kanaal met instelbare frequentie en resolutie (met defaults)
 class LedPwmChannel
 {
 public:
-    // Constructor met optionele frequentie en resolutie
+    // Constructor met optionele frequentie en resolutie (LEDC-kanaal op een pin)
     LedPwmChannel(int channel, int pin,
                   uint32_t freq = 3000,
                   uint8_t resBits = 12);
+    // Kanaal van een andere driver (bv. Pca9685: channel = uitgang 0..16*borden-1, geen pin)
+    LedPwmChannel(PwmDriver& driver, int channel, uint32_t freq, uint8_t resBits);
 
     // Initialiseer het kanaal
     void begin();
-    // Stel de duty cycle in (0..maxDuty())
-    void setDuty(uint16_t duty);
+    // Stel de duty cycle in (0..maxDuty()); wordt pas bij commit() naar de LEDC geschreven
+    void setDuty(uint16_t duty) {
+        uint16_t m = maxDuty();
+        pending = duty > m ? m : duty;
+        ++requests;
+    }
+    // Per frame: schrijf de laatst ingestelde duty alleen als die afwijkt van wat al in de LEDC staat.
+    // Inline: de Compositor roept dit elk frame voor elk kanaal aan, meestal zonder wijziging.
+    void commit() {
+        if (hwValid && pending == written) return; // ongewijzigd: geen ledcWrite
+        writeOut();
+    }
 
     //Getter methods
     uint16_t maxDuty() const { return (1u << resBits) - 1u; }
@@ -21,14 +63,34 @@ public:
     int pinNumber() const { return pin; }
     uint32_t frequency() const { return freq; }
     uint8_t resolutionBits() const { return resBits; }
+    PwmDriver& driver() const { return *drv; }
+    uint16_t duty() const { return pending; }
+
+    // Tellers: setDuty()-aanroepen vs. echte ledcWrite's (verschil = bespaard busverkeer)
+    uint32_t dutyRequests() const { return requests; }
+    uint32_t writesIssued() const { return issued; }
+    uint32_t writesSuppressed() const { return requests > issued ? requests - issued : 0; }
+    void resetCounters() { requests = 0; issued = 0; }
+
+    // Spoor van alle kanalen: elke echte ledcWrite (DutyTrace.h); nullptr = uit
+    static void setTrace(DutyTraceWriter* w) { trace = w; }
 
     // runtime aanpassingen (herconfigureert ledcSetup)
     void setFrequency(uint32_t newFreq);
     void setResolution(uint8_t newResBits);
 
 private:
+    PwmDriver* drv;
     int ch;
     int pin;
     uint32_t freq; //Hz
     uint8_t resBits; //bits
+
+    uint16_t pending = 0;    // gewenste duty voor dit frame
+    uint16_t written = 0;    // laatst naar de LEDC geschreven duty
+    bool hwValid = false;    // false na begin()/ledcSetup: eerstvolgende commit() schrijft altijd
+    uint32_t requests = 0, issued = 0;
+    static DutyTraceWriter* trace;
+
+    void writeOut();
 };
\ No newline at end of file
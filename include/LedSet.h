@@ -1,65 +1,94 @@
 #pragma once
-#include <Arduino.h>
-#include "LedPwm.h"
+#include "Hal.h"
+#include "Compositor.h"
 
 class LedSet {
 public:
   
-  // channels = array van pointers of referenties is ook prima; hier nemen we pointer naar array
-  LedSet(LedPwmChannel** channels, int count, const float* weights)
-    : chans(channels), n(count), w(weights) {}
+  // Een LedSet schrijft in zijn eigen FrameLayer; de Compositor mengt en commit de lagen per frame
+  LedSet(FrameLayer& target, const float* weights)
+    : layer(target), n(target.size()), w(weights),
+      mulQ16(new uint32_t[n > 0 ? n : 1]), selected(new bool[n > 0 ? n : 1]) {
+    rebuildMultipliers();
+  }
+  ~LedSet() { delete[] mulQ16; delete[] selected; }
+  LedSet(const LedSet&) = delete;
+  LedSet& operator=(const LedSet&) = delete;
   
   void setOverlay(float f) {             // 0..1
-    if (f < 0) f = 0; if (f > 1) f = 1;
+    if (f < 0) f = 0;
+    if (f > 1) f = 1;
     overlayFactor = f;
+    rebuildMultipliers();
+  }
+
+  // Nieuwe weights (bv. runtime aangepast scenario): multipliers opnieuw berekenen
+  void setWeights(const float* weights) {
+    w = weights;
+    rebuildMultipliers();
   }
 
   void setAllScaled(uint16_t duty) {
     for (int i = 0; i < n; ++i) {
-      uint32_t d = duty;
-      if (w) d = (uint32_t)(w[i] * d);
-      d = (uint32_t)(overlayFactor * d);  // ← overlay toegepast
-      if (d > 65535u) d = 65535u;
-      chans[i]->setDuty((uint16_t)d);
+      layer.set(i, scaleQ16(i, duty));
     }
   }
 
   // Schrijf alleen kanalen met w[i] > 0  (handig voor overlay/blink)
   void setAllScaledMasked(uint16_t duty) {
     for (int i = 0; i < n; ++i) {
-      if (!w || w[i] <= 0.0f) continue;            // kanaal overslaan
-      uint32_t d = (uint32_t)(w[i] * duty);
-      d = (uint32_t)(overlayFactor * d);
-      if (d > 65535u) d = 65535u;
-      chans[i]->setDuty((uint16_t)d);
+      if (!selected[i]) continue;            // kanaal overslaan
+      layer.set(i, scaleQ16(i, duty));
     }
   }
 
   // Schrijf 1 kanaal, met weight-mask en overlay
   void setOneScaledMasked(int i, uint16_t duty) {
-    if (!w || i < 0 || i >= n || w[i] <= 0.0f) return;   // alleen geselecteerde kanalen
-    uint32_t d = (uint32_t)(w[i] * duty);
-    d = (uint32_t)(overlayFactor * d);
-    if (d > 65535u) d = 65535u;
-    chans[i]->setDuty((uint16_t)d);
+    if (i < 0 || i >= n || !selected[i]) return;   // alleen geselecteerde kanalen
+    layer.set(i, scaleQ16(i, duty));
   }
 
-  void setAll(uint16_t duty) { // geen weight
-    for (int i = 0; i < n; ++i) chans[i]->setDuty(duty);
+  // Lineaire ramp naar duty (geschaald, gemaskeerd) in ms; de Compositor mengt die per frame
+  void fadeAllScaledMasked(uint16_t duty, uint32_t ms, uint32_t now) {
+    for (int i = 0; i < n; ++i) {
+      if (!selected[i]) continue;
+      layer.fade(i, scaleQ16(i, duty), ms, now);
+    }
   }
 
-  uint16_t maxDuty() const {
-    // aangenomen: alle kanalen zelfde resolutie — pak de 1e
-    return n > 0 ? chans[0]->maxDuty() : 4095;
+  void setAll(uint16_t duty) { // geen weight
+    for (int i = 0; i < n; ++i) layer.set(i, duty);
   }
 
-  int size() const { return n; }
+  uint16_t maxDuty() const { return layer.maxDuty(); }
 
+  int size() const { return n; }
+  FrameLayer& target() { return layer; }
 
+  // gecombineerde weight x overlay in Q16 (65536 = 1.0)
+  uint32_t multiplierQ16(int i) const { return (i >= 0 && i < n) ? mulQ16[i] : 0; }
 
 private:
-  LedPwmChannel** chans;
+  FrameLayer& layer;
   int n;
   const float* w; // per-kanaal gewicht (0..1), kan null zijn
   float overlayFactor = 1.0f; // 1.0 = geen effect, 0.0 = volledig uit
-};
\ No newline at end of file
+  uint32_t* mulQ16;   // w[i] * overlayFactor in Q16, bijgewerkt bij elke weight/overlay-wijziging
+  bool* selected;     // w[i] > 0 (masker voor de *Masked-varianten)
+
+  // Hot path: één integer multiply-shift i.p.v. twee float-vermenigvuldigingen.
+  // duty (<= 65535) * mul (<= 65536) past precies in 32 bits.
+  uint16_t scaleQ16(int i, uint16_t duty) const {
+    return (uint16_t)(((uint32_t)duty * mulQ16[i]) >> 16);
+  }
+
+  void rebuildMultipliers() {
+    for (int i = 0; i < n; ++i) {
+      float f = (w ? w[i] : 1.0f) * overlayFactor;
+      if (f < 0) f = 0;
+      if (f > 1) f = 1;
+      mulQ16[i] = (uint32_t)(f * 65536.0f + 0.5f);
+      selected[i] = w && w[i] > 0.0f;
+    }
+  }
+};
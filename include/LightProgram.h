@@ -1,8 +1,12 @@
 // --- file: LightProgram.h
 #pragma once
-#include <Arduino.h>
+#include "Hal.h"
 #include "LedPwm.h"
 #include "LedSet.h"
+#include "WaveTable.h"
+#include "WakeScheduler.h"
+#include "Rng.h"
+#include "StrikeField.h"
 
 class LightProgram
 {
@@ -11,19 +15,52 @@ public:
     virtual ~LightProgram() = default; // virtual destructor for base class
     virtual void start(uint32_t now) = 0; // start the program
     virtual void update(uint32_t now) = 0; // update the program state
+    // ms tot de volgende update() iets te doen heeft (WakeScheduler); 0 = elke loop()
+    virtual uint32_t nextWakeIn(uint32_t now) const { (void)now; return 0; }
+
+    // Eigen PRNG per programma: zelfde seed = zelfde verloop (ook in de native simulator)
+    void seed(uint64_t s) { rng.seed(s); }
+    uint64_t seedValue() const { return rng.seedValue(); }
+
+protected:
+    Rng rng;
 };
 
 // ===== ProgThunder =====
 class ProgThunder : public LightProgram
 {
 public:
-    ProgThunder(LedSet &set, const float *weights) : leds(set), w(weights) {}    // was: ProgThunder(LedPwmChannel& a, LedPwmChannel& b);
+    // field: posities van de kanalen van set (gedeeld, moet blijven bestaan); nullptr = kanalen op een lijn
+    ProgThunder(LedSet &set, const float *weights, const StrikeField *field = nullptr);    // was: ProgThunder(LedPwmChannel& a, LedPwmChannel& b);
+    ~ProgThunder() override { delete[] chOffsetMs; delete[] chGainQ8; delete ownField; }
+    ProgThunder(const ProgThunder&) = delete;
+    ProgThunder& operator=(const ProgThunder&) = delete;
     void start(uint32_t now) override;
     void update(uint32_t now) override;
+    uint32_t nextWakeIn(uint32_t now) const override;
+
+    // Audio-sync: zolang aan, plant het programma zelf geen random bursts; een CueScheduler
+    // roept triggerBurst() aan zodat de flits samenvalt met de donderklap in de track.
+    void setCueSync(bool on) { cueSync = on; }
+    bool cueSyncActive() const { return cueSync; }
+    // Start direct een burst: intensity 0..255 (van maxDuty), subs 1..kMaxSubs, preglow in ms
+    void triggerBurst(uint32_t now, uint8_t intensity, uint8_t subs, uint32_t preGlowMs);
+    uint32_t burstsStarted() const { return bursts; }
+    // Volger (bv. de pixelstrip): krijgt elke burst van dit programma als triggerBurst(), zelfde
+    // moment/intensiteit/subflitsen. Zet op de volger zelf setCueSync(true) (geen eigen ritme).
+    void setFollower(ProgThunder* f) { follower = f; }
+
+    // Ruimtelijk model van de huidige subflits (StrikeField): inslagpunt, aankomst en helderheid per kanaal
+    int strikeOrigin() const { return origin; }
+    uint16_t channelDelayMs(int i) const { return chOffsetMs[i]; }
+    uint16_t channelGainQ8(int i) const { return chGainQ8[i]; }   // 256 = volle flits
 
 private:
     LedSet &leds;
     const float *w; // scenario-weights (uit Config)
+    bool cueSync = false;
+    uint32_t bursts = 0;
+    ProgThunder* follower = nullptr;
 
     enum Phase
     {
@@ -40,13 +77,17 @@ private:
     uint16_t subIntensity[kMaxSubs]; // doelintensiteit per sub (0..maxDuty)
     uint16_t afterStartDuty = 0;
 
-    // per-kanaal offsets voor deze burst
-    static constexpr int kMaxCh = 16;        // aantal kanalen, 16 is veilig voor 4 kanalen. Gebruik een grotere waarde als je meer kanalen hebt.
-    uint16_t chOffsetMs[kMaxCh] = {0};       // per kanaal random 0..25 ms
-    void refreshOffsets(uint16_t intensity); // berekent offsets per subflits
+    // per kanaal voor deze subflits, uit de afstand tot het inslagpunt (één per kanaal van de LedSet)
+    const StrikeField* field;
+    StrikeField* ownField = nullptr;         // lijn-opstelling als er geen field is meegegeven
+    uint16_t* chOffsetMs;                    // aankomst na phaseStart, 2..40 ms
+    uint16_t* chGainQ8;                      // helderheid, 256 = vol (STRIKE_FALLOFF)
+    uint16_t skewEndMs = 0;                  // grootste chOffsetMs: daarna verandert er niets meer tot phaseEnd
+    uint8_t origin = 0;                      // inslagpunt van StrikeField
+    void refreshOffsets(uint16_t intensity); // berekent offsets en helderheid per subflits
     
-    static uint32_t randRange(uint32_t a, uint32_t b) { return a + (esp_random() % (b - a + 1)); } //return random int in [a,b]
-    static float rand01() { return (esp_random() & 0xFFFF) / 65535.0f; } //return random float in [0..1]
+    uint32_t randRange(uint32_t a, uint32_t b) { return rng.range(a, b); } //return random int in [a,b]
+    float rand01() { return rng.unit(); } //return random float in [0..1]
 
     // helpers:
     void setAll(uint16_t d) { leds.setAllScaled(d); } // <— scaled per scenario-weight
@@ -55,6 +96,7 @@ private:
     void setWithSkew(uint16_t duty, uint32_t now);
     void scheduleNextBurst(uint32_t now);
     void prepareBurst(uint32_t now);
+    void startBurst(uint32_t now, int subs, float base, uint32_t preDur); // base < 0 / preDur 0 = random
 };
 
 // ===== ProgDay =====
@@ -64,19 +106,23 @@ public:
     ProgDay(LedSet &set, const float *weights) : leds(set), w(weights) {}
     void start(uint32_t now) override;
     void update(uint32_t now) override;
+    uint32_t nextWakeIn(uint32_t now) const override { return WakeScheduler::until(now, nextUpdate); }
+
+    // helderheid 0.35 + 0.25*(0.5+0.5*sin(fase)), geschaald naar maxv; alleen integer-rekenwerk
+    static uint16_t waveDuty(uint32_t phase, uint16_t maxv)
+    {
+        uint32_t level = 22938u + (Wave::sine01(phase) >> 2); // Q16: 0.35 .. 0.60
+        return (uint16_t)((level * maxv) >> 16);
+    }
+    static constexpr uint32_t PhaseStep = Wave::phaseFromRadians(0.055);   // per tick (10 ms)
+    static constexpr uint32_t PhaseOffset2 = Wave::phaseFromRadians(1.3);  // tweede LED
 
 private:
     LedSet &leds;
     const float* w; // scenario-weights (uit Config)
     uint32_t nextUpdate = 0;
-    float basePhase = 0.f;
+    uint32_t basePhase = 0; // 2^32 = 2*pi, overloop is de wrap
     int sparkle1 = 0, sparkle2 = 0;
-    static constexpr float TwoPi = 6.28318530718f;
-    static uint16_t scale(float x, uint16_t maxv)
-    {
-        x = constrain(x, 0.f, 1.f);
-        return (uint16_t)(x * maxv);
-    }
     void setAll(uint16_t d) { leds.setAllScaled(d); } // <— scaled per scenario-weight
     inline void setAllMasked(uint16_t d) { leds.setAllScaledMasked(d); }
 };
@@ -0,0 +1,86 @@
+// --- file: LoopProfiler.h
+#pragma once
+#include "Hal.h"
+
+// Meet per loop()-iteratie hoeveel tijd elke stap kost, plus de periode tussen twee iteraties.
+// Per stap: aantal, totaal, slechtste geval en een log2-histogram in microseconden.
+// Gebruik: beginLoop() aan het begin van loop(), mark(stap) na elke stap, endLoop() aan het eind.
+// Eén profiler per taak (render/I/O); elke taak markeert alleen zijn eigen stappen.
+class LoopProfiler {
+public:
+    enum Stage : uint8_t {
+        Buttons = 0, // knopgebeurtenissen uit de queues (moduswissel, volume)
+        SerialIn,    // pollSerial()
+        Audio,       // sv5w.poll()
+        Busy,        // BUSY-debounce
+        Actions,     // I/O: meldingen van de render-taak; render: opdrachten uit de I/O-queue
+        Program,     // currentProg->update()
+        Blink,       // gBlink.update()
+        Commit,      // Compositor::commit(): lagen mengen en naar de kanalen schrijven
+        Loop,        // hele iteratie
+        Period,      // tijd tussen het begin van twee iteraties (jitter)
+        COUNT
+    };
+
+    // bucket k: [2^k, 2^(k+1)) us; bucket 0 bevat ook 0 us, laatste bucket alles >= 2^(kBuckets-1) us (~131 ms)
+    static constexpr int kBuckets = 18;
+
+    struct Stats {
+        uint32_t count = 0;
+        uint64_t totalUs = 0;
+        uint32_t worstUs = 0;
+        uint32_t hist[kBuckets] = {0};
+    };
+
+    void beginLoop() {
+        uint32_t t = Hal::micros();
+        if (started) record(Period, t - loopStart);
+        started = true;
+        loopStart = t;
+        markT = t;
+    }
+
+    // sluit stap s af: tijd sinds beginLoop() of de vorige mark()
+    void mark(Stage s) {
+        uint32_t t = Hal::micros();
+        record(s, t - markT);
+        markT = t;
+    }
+
+    void endLoop() { record(Loop, Hal::micros() - loopStart); }
+
+    void reset() {
+        for (int i = 0; i < COUNT; ++i) st[i] = Stats();
+        started = false;
+    }
+
+    const Stats& stats(Stage s) const { return st[s]; }
+    uint32_t averageUs(Stage s) const { return st[s].count ? (uint32_t)(st[s].totalUs / st[s].count) : 0; }
+
+    static const char* stageName(Stage s) {
+        static const char* const names[COUNT] = { "buttons", "serial", "audio", "busy", "actions", "program", "blink", "commit", "loop", "period" };
+        return (s < COUNT) ? names[s] : "?";
+    }
+
+    // ondergrens (us) van een histogram-bucket
+    static uint32_t bucketFloorUs(int b) { return b <= 0 ? 0 : (1u << b); }
+
+private:
+    Stats st[COUNT];
+    uint32_t loopStart = 0, markT = 0;
+    bool started = false;
+
+    static int bucketOf(uint32_t us) {
+        int b = 0;
+        while (us > 1 && b < kBuckets - 1) { us >>= 1; ++b; }
+        return b;
+    }
+
+    void record(Stage s, uint32_t us) {
+        Stats& x = st[s];
+        ++x.count;
+        x.totalUs += us;
+        if (us > x.worstUs) x.worstUs = us;
+        ++x.hist[bucketOf(us)];
+    }
+};
@@ -0,0 +1,64 @@
+// --- file: Pca9685.h
+#pragma once
+#include "Hal.h"
+#include "LedPwm.h"
+
+// PwmDriver voor één of meer PCA9685-borden (16 x 12-bit PWM per bord, I2C) naast/in plaats van de LEDC.
+// Kanaal k = uitgang k % 16 van bord k / 16 (adres firstAddr + k / 16).
+// write() buffert alleen; flush() (einde frame, Compositor::commit) stuurt per bord met gewijzigde
+// uitgangen één I2C-transactie: registeradres + 4 bytes per uitgang van de eerste t/m de laatste
+// gewijzigde uitgang (auto-increment). Een vol bord = 65 bytes, binnen de 128-byte Wire-buffer.
+// Mislukt die transactie (NACK, busfout), dan blijft het bereik staan en meldt pending() dat; de
+// volgende flush() stuurt het opnieuw, met de dan nieuwste duty's.
+class Pca9685 : public PwmDriver
+{
+public:
+    static constexpr int kChannelsPerChip = 16;
+    static constexpr int kMaxChips = 4;
+    static constexpr uint32_t kOscHz = 25000000; // interne oscillator
+
+    // registers
+    static constexpr uint8_t kMode1 = 0x00;
+    static constexpr uint8_t kMode2 = 0x01;
+    static constexpr uint8_t kLed0OnL = 0x06;
+    static constexpr uint8_t kPreScale = 0xFE;
+
+    Pca9685(Hal::I2cBus& bus, uint8_t firstAddr, int chips);
+
+    // reset naar bekende toestand, PWM-frequentie (24..1526 Hz), auto-increment; false = een bord antwoordt niet
+    bool begin(uint32_t pwmFreq);
+
+    void setup(int ch, int pin, uint32_t freq, uint8_t resBits) override;
+    void write(int ch, uint32_t duty) override;
+    void flush() override;
+    bool pending() const override;      // een bord met gewijzigde uitgangen die nog niet aankwamen
+    int traceBase() const override { return DutyTrace::kBasePca9685; }
+
+    int channels() const { return chips * kChannelsPerChip; }
+    uint8_t address(int chip) const { return (uint8_t)(addr0 + chip); }
+
+    // prescaler voor freq (datasheet 7.3.5), begrensd op 3..255
+    static uint8_t prescaleFor(uint32_t freq);
+    // de 4 registerbytes (ON_L, ON_H, OFF_L, OFF_H) voor een 12-bit duty; phase verschuift de
+    // aan-flank per uitgang zodat niet alle LED's tegelijk inschakelen (piekstroom)
+    static void encode(uint16_t duty12, uint16_t phase, uint8_t out[4]);
+
+    // tellers
+    uint32_t transactions() const { return txCount; }
+    uint64_t bytesSent() const { return txBytes; }
+    uint32_t errors() const { return txErrors; }
+
+private:
+    Hal::I2cBus& bus;
+    uint8_t addr0;
+    int chips;
+    uint32_t freqHz = 0;
+    uint16_t duty[kMaxChips * kChannelsPerChip] = {};   // 12-bit, klaar voor de volgende flush
+    uint8_t resBits[kMaxChips * kChannelsPerChip] = {};  // resolutie van het LedPwmChannel erboven
+    int8_t dirtyLo[kMaxChips], dirtyHi[kMaxChips];       // gewijzigde uitgangen per bord (-1 = geen)
+    uint32_t txCount = 0, txErrors = 0;
+    uint64_t txBytes = 0;
+
+    bool writeReg(int chip, uint8_t reg, uint8_t value);
+    bool setFrequency(int chip, uint32_t freq);
+};
@@ -0,0 +1,46 @@
+// --- file: Perceptual.h
+#pragma once
+#include "Hal.h"
+#include "Config.h"
+
+// Perceptuele helderheid -> lineaire PWM-duty (CIE 1976 L*).
+// Programma's en lagen werken in perceptuele ruimte (0..maxDuty = 0..100% waargenomen helderheid);
+// de Compositor zet het gemengde frame hier om naar duty. Zo krijgen de donkere delen van fades
+// (nagloei, dal van ProgDay) de fijne stappen en wordt de bovenkant niet verspild.
+// De tabel wordt compile-time opgebouwd voor Config::LEDC_RES_BITS (max. 12 bits = 8 KB flash);
+// de inverse L*-curve is een derdemacht, dus geen powf, ook niet bij het bouwen.
+namespace Perceptual {
+
+constexpr int kBits = Config::LEDC_RES_BITS < 12 ? Config::LEDC_RES_BITS : 12;
+constexpr uint16_t kMax = (uint16_t)((1u << kBits) - 1);
+
+// L* (0..1) -> relatieve luminantie Y (0..1)
+constexpr double luminance(double l) {
+    double L = l * 100.0;
+    if (L <= 8.0) return L / 903.2962962;      // lineair stuk bij zwart
+    double t = (L + 16.0) / 116.0;
+    return t * t * t;
+}
+
+struct Table {
+    uint16_t v[kMax + 1];
+    constexpr Table() : v() {
+        for (int i = 0; i <= kMax; ++i)
+            v[i] = (uint16_t)(luminance((double)i / kMax) * kMax + 0.5);
+    }
+};
+
+inline constexpr Table kTable{};
+static_assert(kTable.v[0] == 0 && kTable.v[kMax] == kMax, "L*-tabel moet 0 en vol bereik halen");
+
+// Perceptuele waarde p (0..maxv) -> duty (0..maxv). maxv = huidige resolutie van het kanaal;
+// wijkt die af van de tabel (setResolution op runtime), dan wordt er herschaald.
+inline uint16_t toDuty(uint16_t p, uint16_t maxv) {
+    if (maxv == kMax) return kTable.v[p > kMax ? kMax : p];
+    if (maxv == 0) return 0;
+    uint32_t idx = (uint32_t)p * kMax / maxv;
+    if (idx > kMax) idx = kMax;
+    return (uint16_t)(((uint32_t)kTable.v[idx] * maxv + kMax / 2) / kMax);
+}
+
+} // namespace Perceptual
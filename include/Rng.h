@@ -0,0 +1,82 @@
+// --- file: Rng.h
+#pragma once
+#include <stdint.h>
+
+// Kleine, snelle PRNG met expliciete seed (xoshiro128**, 128 bit state, alleen 32-bit bewerkingen:
+// goedkoop op de Xtensa). Elk programma heeft er een eigen; met dezelfde seed geeft het exact
+// dezelfde storm, ook in de native simulator (--seed). Niet cryptografisch.
+//   Rng rng(Rng::derive(masterSeed, stroom));
+//   rng.range(15, 60);   // gelijkverdeeld in [15, 60], zonder modulo-bias
+class Rng {
+public:
+    explicit Rng(uint64_t s = 1) { seed(s); }
+
+    // state vullen met splitmix64; elke seed (ook 0) geeft een bruikbare, niet-nul state
+    void seed(uint64_t s) {
+        seed_ = s;
+        uint64_t x = s;
+        for (int i = 0; i < 4; i += 2) {
+            uint64_t z = splitmix64(x);
+            st[i] = (uint32_t)z;
+            st[i + 1] = (uint32_t)(z >> 32);
+        }
+    }
+    uint64_t seedValue() const { return seed_; }
+
+    // Onafhankelijke seed per stroom (programma, SV5W, ...) uit één master-seed
+    static uint64_t derive(uint64_t master, uint32_t stream) {
+        uint64_t x = master ^ ((uint64_t)stream * 0xD1B54A32D192ED03ull);
+        return splitmix64(x);
+    }
+
+    uint32_t next() {
+        uint32_t result = rotl(st[1] * 5, 7) * 9;
+        uint32_t t = st[1] << 9;
+        st[2] ^= st[0];
+        st[3] ^= st[1];
+        st[1] ^= st[2];
+        st[0] ^= st[3];
+        st[2] ^= t;
+        st[3] = rotl(st[3], 11);
+        return result;
+    }
+
+    // gelijkverdeeld in [0, n), n > 0 (Lemire: vermenigvuldigen i.p.v. %, verwerpen alleen in de
+    // zeldzame rand waar de bias zou zitten; de deling gebeurt dan ook pas)
+    uint32_t below(uint32_t n) {
+        uint64_t m = (uint64_t)next() * n;
+        uint32_t low = (uint32_t)m;
+        if (low < n) {
+            uint32_t threshold = (uint32_t)(0u - n) % n;
+            while (low < threshold) {
+                m = (uint64_t)next() * n;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    // gelijkverdeeld in [a, b] (a <= b)
+    uint32_t range(uint32_t a, uint32_t b) {
+        uint32_t span = b - a + 1;
+        return span ? a + below(span) : next(); // span 0: het hele 32-bit bereik
+    }
+
+    // [0..1], 16 bit resolutie
+    float unit() { return (next() >> 16) / 65535.0f; }
+
+    // true met kans 1/n
+    bool oneIn(uint32_t n) { return below(n) == 0; }
+
+private:
+    uint32_t st[4];
+    uint64_t seed_ = 0;
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
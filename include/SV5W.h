@@ -1,11 +1,15 @@
 // --- file: SV5W.h
 #pragma once
-#include <Arduino.h>
-#include <vector>
+#include "Hal.h"
+#include "WakeScheduler.h"
+#include "Rng.h"
+#include <stdio.h>
 
 // Lightweight UART driver for DY-SV5W voice module (UART mode)
 // Protocol per datasheet: Start=0xAA, CMD, LEN, DATA[LEN], CHECKSUM(low 8 bits of sum)
 // Baud: 9600, 8N1
+// Non-blocking: commando's gaan via een TX-queue en antwoorden via een incrementele RX-parser;
+// beide worden gepompt door poll() vanuit loop().
 
 class SV5W {
 public:
@@ -45,18 +49,40 @@ public:
     SELECT_NO_PLAY      = 0x1F  // AA 1F 02 <idxH> <idxL> SM
   };
 
+  // LEN is één byte: payload max. 255, frame = AA + CMD + LEN + DATA + SM
+  static constexpr size_t kMaxPayload = 255;
+  static constexpr size_t kMaxFrame = kMaxPayload + 4;
+
+  // Vaste inline opslag: geen heap-allocaties per query/antwoord
   struct Response {
     uint8_t cmd = 0;      // echoed command
-    std::vector<uint8_t> data; // payload
+    uint8_t len = 0;      // aantal geldige bytes in data
+    uint8_t data[kMaxPayload]; // payload
     bool valid = false;   // checksum ok and length matches
+
+    size_t size() const { return len; }
+    const uint8_t* begin() const { return data; }
+    const uint8_t* end() const { return data + len; }
   };
 
+  using ResponseCallback = void (*)(const Response& r, void* ctx);
+  using SentCallback = void (*)(Command cmd, uint32_t now, void* ctx);
+
+  // Initialize with any byte stream (UART adapter, or the SV5W mock on the native build).
+  // baud is only used to pace frames by their wire time.
+  void begin(Hal::ByteStream& stream, uint32_t baud = 9600, uint32_t respTimeoutMs = 50) {
+    serial_ = &stream;
+    timeoutMs_ = respTimeoutMs;
+    baud_ = baud ? baud : 9600;
+  }
+
+#ifndef HAL_NATIVE
   // Initialize with a HardwareSerial (e.g., Serial2), RX/TX pins and baud (default 9600)
   void begin(HardwareSerial& port, int rxPin, int txPin, uint32_t baud = 9600, uint32_t respTimeoutMs = 50) {
-    serial_ = &port;
-    serial_->begin(baud, SERIAL_8N1, rxPin, txPin);
-    timeoutMs_ = respTimeoutMs;
+    uart_.begin(port, baud, rxPin, txPin);
+    begin(uart_, baud, respTimeoutMs);
   }
+#endif
 
   // --- High-level helpers ---
   void play()                     { sendSimple(Command::PLAY); }
@@ -94,8 +120,7 @@ public:
 
   // Play a specific song index (1..65535) per datasheet numbering
   void playTrack(uint16_t index) { 
-    if(index == 0) index = 1; // clamp to min
-    else if(index > 65535) index = 65535; // clamp to max
+    if(index == 0) index = 1; // clamp to min (uint16_t: max 65535 vanzelf)
     uint8_t d[2] = { (uint8_t)(index >> 8), (uint8_t)index };
     sendWithData(Command::SPECIFIED_SONG, d, 2);
   }
@@ -120,18 +145,23 @@ public:
     uint8_t plen = (uint8_t)strnlen(path, 250); // limit
     // LEN = 1 (drive) + N (path)
     uint8_t len = (uint8_t)(1 + plen);
-    uint8_t *buf = (uint8_t *)alloca(len);
+    uint8_t buf[kMaxPayload];
     buf[0] = drive;
     memcpy(buf + 1, path, plen);
     sendWithData(Command::SPECIFIED_PATH, buf, len);
   }
   // Overload: gebruik standaard drive die we bijhouden (default 0x01=SD)
   void playByPath(const char* path) { playByPath(defaultDrive_, path); }
+#ifndef HAL_NATIVE
   void playByPath(const String& path) { playByPath(defaultDrive_, path.c_str()); }
+#endif
   // Default drive beheren
   void setDefaultDrive(uint8_t drive) { defaultDrive_ = drive; }
   uint8_t defaultDrive() const { return defaultDrive_; }
 
+  // seed voor playRandomFolderClip() (zelfde seed = zelfde clipvolgorde)
+  void seedRandom(uint64_t seed) { rng_.seed(seed); }
+
   // Speel een willekeurig bestand uit een map met numerieke bestandsnamen (bv. \FOLDER\00001.MP3 .. \FOLDER\00020.MP3)
   void playRandomFolderClip(const char *folder,
                             uint16_t maxIndex,
@@ -145,7 +175,7 @@ public:
 
     // Kies random index binnen [minIndex, maxIndex]
     uint16_t span = (uint16_t)(maxIndex - minIndex + 1);
-    uint16_t idx = (uint16_t)(minIndex + (esp_random() % span));
+    uint16_t idx = (uint16_t)(minIndex + rng_.below(span));
 
     // Bestandsnaam: 00001.MP3
     char fname[16];
@@ -191,96 +221,126 @@ public:
     playByPath(path);
   }
 
-  // --- Queries (read back a short response) ---
-  Response queryPlayStatus()            { return sendAndRead(Command::QUERY_PLAY_STATUS); }
-  Response queryCurrentOnlineDrive()    { return sendAndRead(Command::QUERY_CURRENT_ONLINE_DRIVE); }
-  Response queryCurrentPlayDrive()      { return sendAndRead(Command::QUERY_CURRENT_PLAY_DRIVE); }
-  Response queryNumberOfSongs()         { return sendAndRead(Command::QUERY_NUMBER_OF_SONGS); }
-  Response queryCurrentSong()           { return sendAndRead(Command::QUERY_CURRENT_SONG); }
-  Response queryFolderDirSong()         { return sendAndRead(Command::QUERY_FOLDER_DIR_SONG); }
-  Response queryFolderSongCount()       { return sendAndRead(Command::QUERY_FOLDER_SONG_COUNT); }
-  Response queryVersion()               { return sendAndRead(Command::QUERY_VERSION); }
-
-  // Low-level: send arbitrary command with a data buffer
-  void sendWithData(Command cmd, const uint8_t* data, uint8_t len) {
-    if (!serial_){
-      Serial.println(F("ERROR: no serial!"));
-      return;
-    } 
-    const uint8_t start = 0xAA; //Start byte SV5W command
-    const uint8_t c = (uint8_t)cmd;
-    uint8_t checksum = start + c + len;
-    //Serial.println(cmd)
-    serial_->write(start);
-    serial_->write(c);
-    serial_->write(len);
-    for (uint8_t i = 0; i < len; ++i) {
-      checksum += data[i];
-      serial_->write(data[i]);
-    }
-    checksum &= 0xFF; // low 8 bits
-    serial_->write(checksum);
+  // --- Queries (asynchroon: het antwoord komt via de callback, vanuit poll()) ---
+  // Bij een timeout of checksumfout krijgt de callback een Response met valid=false.
+  bool queryPlayStatus(ResponseCallback cb, void* ctx = nullptr)         { return sendQuery(Command::QUERY_PLAY_STATUS, cb, ctx); }
+  bool queryCurrentOnlineDrive(ResponseCallback cb, void* ctx = nullptr) { return sendQuery(Command::QUERY_CURRENT_ONLINE_DRIVE, cb, ctx); }
+  bool queryCurrentPlayDrive(ResponseCallback cb, void* ctx = nullptr)   { return sendQuery(Command::QUERY_CURRENT_PLAY_DRIVE, cb, ctx); }
+  bool queryNumberOfSongs(ResponseCallback cb, void* ctx = nullptr)      { return sendQuery(Command::QUERY_NUMBER_OF_SONGS, cb, ctx); }
+  bool queryCurrentSong(ResponseCallback cb, void* ctx = nullptr)        { return sendQuery(Command::QUERY_CURRENT_SONG, cb, ctx); }
+  bool queryFolderDirSong(ResponseCallback cb, void* ctx = nullptr)      { return sendQuery(Command::QUERY_FOLDER_DIR_SONG, cb, ctx); }
+  bool queryFolderSongCount(ResponseCallback cb, void* ctx = nullptr)    { return sendQuery(Command::QUERY_FOLDER_SONG_COUNT, cb, ctx); }
+  bool queryVersion(ResponseCallback cb, void* ctx = nullptr)            { return sendQuery(Command::QUERY_VERSION, cb, ctx); }
+
+  // Low-level: zet een commando met data in de TX-queue (false = queue vol, commando vervalt)
+  bool sendWithData(Command cmd, const uint8_t* data, uint8_t len) {
+    return enqueue(cmd, data, len, false, nullptr, nullptr);
   }
 
-  // Low-level: send a no-data command (LEN=0)
-  void sendSimple(Command cmd) {
-    if (!serial_) return;
-    const uint8_t start = 0xAA; //Start byte SV5W command
-    const uint8_t c = (uint8_t)cmd;
-    uint8_t checksum = (start + c + 0) & 0xFF;
-    serial_->write(start);
-    serial_->write(c);
-    serial_->write((uint8_t)0x00);
-    serial_->write(checksum);
-  }
+  // Low-level: no-data commando (LEN=0) in de TX-queue
+  bool sendSimple(Command cmd) { return enqueue(cmd, nullptr, 0, false, nullptr, nullptr); }
 
-  // Send and try to read a response frame (non-blocking-friendly, but uses a small timeout)
-  Response sendAndRead(Command cmd) {
-    sendSimple(cmd);
-    return readFrame();
+  // Query in de queue; het antwoord (of de timeout) komt via cb
+  bool sendQuery(Command cmd, ResponseCallback cb, void* ctx = nullptr) {
+    return enqueue(cmd, nullptr, 0, true, cb, ctx);
   }
 
-  // Read any incoming frame (AA, CMD, LEN, DATA, SM). Returns {valid=false} if timeout or invalid.
-  Response readFrame() {
-    Response r; r.valid = false;
-    if (!serial_) return r;
-
-    uint32_t t0 = millis();
-    int stage = 0; // 0=wait AA, 1=CMD, 2=LEN, 3=DATA, 4=CHECK
-    uint8_t cmd = 0, len = 0;
-    std::vector<uint8_t> data;
-    uint8_t sum = 0;
-
-    while (millis() - t0 < timeoutMs_) {
-      if (serial_->available()) {
-        uint8_t b = serial_->read();
-        switch (stage) {
-          case 0: // wait for start byte
-            if (b == 0xAA) { sum = b; stage = 1; }
-            break;
-          case 1: // read command
-            cmd = b; sum += b; stage = 2; break;
-          case 2: // read length
-            len = b; sum += b; data.clear(); data.reserve(len); stage = (len == 0 ? 4 : 3); break;
-          case 3: // read data bytes
-            data.push_back(b); sum += b;
-            if (data.size() == len) stage = 4; break;
-          case 4: { // read checksum
-            uint8_t sm = b; sum &= 0xFF;
-            if (sm == sum) { r.cmd = cmd; r.data = std::move(data); r.valid = true; }
-            return r; // finish regardless
-          }
-        }
-      }
-    }
-    return r; // timeout
+  // Wachttijd in de queue, bv. settle-tijd na STOP vóór het volgende commando (vervangt delay()).
+  // Hoort bij het laatst gequeuede frame: vervalt dat frame door samenvoegen, dan vervalt de gap ook.
+  bool gap(uint16_t ms);
+
+  // Samenvoegen van achterhaalde commando's in de queue (standaard aan):
+  //  - SET_VOLUME vervangt wachtende SET_VOLUME/VOL_UP/VOL_DOWN; VOL_UP/DOWN past een wachtende SET_VOLUME aan
+  //  - SET_EQ/SET_LOOP_MODE/SET_CYCLE_TIMES/SWITCH_SPECIFIED_DRIVE: alleen de laatste blijft
+  //  - STOP/SPECIFIED_SONG/SPECIFIED_PATH/SELECT_NO_PLAY vervangen wachtende transportcommando's
+  //    (dus STOP + SPECIFIED_SONG wordt alleen de play)
+  // Een wachtende query is een barrière: daarvóór wordt niets samengevoegd.
+  void setCoalescing(bool enable) { coalesce_ = enable; }
+
+  // Wordt aangeroepen zodra een frame echt over de UART gaat (na samenvoegen en wachttijden)
+  void onSent(SentCallback cb, void* ctx = nullptr) { sentCb_ = cb; sentCtx_ = ctx; }
+
+  // Frames die niet bij een lopende query horen (bv. meldingen van de module)
+  void onUnsolicited(ResponseCallback cb, void* ctx = nullptr) { unsolicitedCb_ = cb; unsolicitedCtx_ = ctx; }
+
+  // Pomp vanuit loop(): leest binnengekomen bytes, handelt timeouts af en verstuurt het volgende frame.
+  // Blokkeert nooit.
+  void poll(uint32_t now);
+
+  bool idle() const { return txCount_ == 0 && !awaiting_; }
+  // ms tot poll() weer iets te doen heeft: time-out van de lopende query of het volgende frame.
+  // Binnenkomende bytes tellen niet mee; die wekken de pollende taak via het UART-event (Hal::wakeOnReceive).
+  uint32_t nextPollIn(uint32_t now) const {
+    if (awaiting_) return WakeScheduler::until(now, sentAtMs_ + timeoutMs_);
+    if (txCount_ > 0) return WakeScheduler::until(now, nextTxMs_);
+    return WakeScheduler::kForever;
   }
+  size_t pending() const { return txCount_; }
+
+  // Tellers
+  uint32_t framesSent() const { return framesSent_; }
+  uint32_t bytesSent() const { return bytesSent_; }
+  uint32_t timeouts() const { return timeouts_; }
+  uint32_t rxErrors() const { return rxErrors_; }
+  uint32_t dropped() const { return dropped_; }
+  uint32_t framesElided() const { return framesElided_; }
+  uint32_t bytesSaved() const { return bytesSaved_; }
+  void resetCounters() { framesSent_ = bytesSent_ = timeouts_ = rxErrors_ = dropped_ = framesElided_ = bytesSaved_ = 0; }
 
 private:
-  HardwareSerial* serial_ = nullptr;
+  static constexpr size_t kQueueMax = 16;   // max. commando's in de TX-queue
+
+  struct TxEntry {
+    uint8_t bytes[kMaxFrame];    // compleet frame
+    uint16_t size = 0;           // 0 = alleen wachttijd
+    uint16_t gapMs = 0;          // wachttijd na dit item
+    bool query = false;          // wacht op antwoord met hetzelfde CMD
+    ResponseCallback cb = nullptr;
+    void* ctx = nullptr;
+  };
+
+  Hal::ByteStream* serial_ = nullptr;
+#ifndef HAL_NATIVE
+  Hal::UartStream uart_;
+#endif
   uint32_t timeoutMs_ = 50;
+  uint32_t baud_ = 9600;
   uint8_t defaultDrive_ = 0x01; // 0x01 = SD als standaard
-
+  Rng rng_;
+
+  // TX: vaste ringbuffer, geen heap
+  TxEntry txq_[kQueueMax];
+  size_t txHead_ = 0, txCount_ = 0;
+  uint32_t nextTxMs_ = 0;       // vroegste moment voor het volgende frame (draadtijd + gap)
+
+  // lopende query
+  bool awaiting_ = false;
+  uint8_t awaitCmd_ = 0;
+  uint32_t sentAtMs_ = 0;
+  ResponseCallback awaitCb_ = nullptr;
+  void* awaitCtx_ = nullptr;
+  ResponseCallback unsolicitedCb_ = nullptr;
+  void* unsolicitedCtx_ = nullptr;
+  SentCallback sentCb_ = nullptr;
+  void* sentCtx_ = nullptr;
+
+  // RX state machine: 0=wait AA, 1=CMD, 2=LEN, 3=DATA, 4=CHECK
+  uint8_t rxStage_ = 0;
+  uint8_t rxCmd_ = 0, rxLen_ = 0, rxSum_ = 0, rxPos_ = 0;
+  Response rx_;
+
+  bool coalesce_ = true;
+  uint32_t framesSent_ = 0, bytesSent_ = 0, timeouts_ = 0, rxErrors_ = 0, dropped_ = 0;
+  uint32_t framesElided_ = 0, bytesSaved_ = 0;
+
+  bool enqueue(Command cmd, const uint8_t* data, uint8_t len, bool query, ResponseCallback cb, void* ctx);
+  TxEntry* pushEntry();
+  TxEntry& entryAt(size_t k) { return txq_[(txHead_ + k) % kQueueMax]; }
+  void removeAt(size_t k);
+  bool coalesce(Command cmd, const uint8_t* data, uint8_t len);
+  void rxByte(uint8_t b);
+  void frameReceived(const Response& r);
+  void transmit(const TxEntry& e, uint32_t now);
 };
 
 // --- end of SV5W.h ---
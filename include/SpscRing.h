@@ -0,0 +1,41 @@
+// --- file: SpscRing.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free ringbuffer voor precies één producent en één consument (bv. I/O-taak -> render-taak).
+// push() alleen vanuit de producent, pop() alleen vanuit de consument; geen mutex, geen heap.
+// N moet een macht van 2 zijn; head/tail lopen vrij door en worden gemaskeerd (overloop is veilig).
+// Vol = push() geeft false: de aanroeper beslist of dat verloren mag gaan.
+template <class T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing: N moet een macht van 2 zijn");
+
+public:
+    bool push(const T& v) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) return false;
+        buf[h & (N - 1)] = v;
+        head.store(h + 1, std::memory_order_release);   // pas zichtbaar na het schrijven van buf
+        return true;
+    }
+
+    bool pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = buf[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);   // slot weer vrij voor de producent
+        return true;
+    }
+
+    // momentopname; vanuit de andere kant kan hij al veranderd zijn
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T buf[N];
+    std::atomic<uint32_t> head{0};   // geschreven door de producent
+    std::atomic<uint32_t> tail{0};   // geschreven door de consument
+};
@@ -0,0 +1,85 @@
+// --- file: StaticLedSet.h
+#pragma once
+#include <utility>
+#include "Hal.h"
+#include "Compositor.h"
+
+// Compile-time variant van LedSet voor sets waarvan kanaalaantal en weights vastliggen in Config.h:
+//   StaticLedSet<Config::LED_COUNT, Config::LEDSET_BLINK_WEIGHTS> blink(layer);
+// Het masker (W[i] > 0) is een constante: de lus wordt uitgerold en kanalen met weight 0
+// verdwijnen uit de code. Schaling en overlay zijn identiek aan LedSet (zelfde Q16-multipliers),
+// dus beide zijn uitwisselbaar voor code die als template op de set werkt (zie BlinkOverlay).
+template <int N, const float (&W)[N]>
+class StaticLedSet {
+public:
+  static_assert(N > 0, "StaticLedSet heeft minstens één kanaal nodig");
+
+  explicit StaticLedSet(FrameLayer& target) : layer(target) { rebuildMultipliers(); }
+  StaticLedSet(const StaticLedSet&) = delete;
+  StaticLedSet& operator=(const StaticLedSet&) = delete;
+
+  void setOverlay(float f) {             // 0..1
+    if (f < 0) f = 0;
+    if (f > 1) f = 1;
+    overlayFactor = f;
+    rebuildMultipliers();
+  }
+
+  void setAllScaled(uint16_t duty) { writeAll<false>(duty, std::make_integer_sequence<int, N>{}); }
+
+  // Schrijf alleen kanalen met W[i] > 0; het masker is compile-time
+  void setAllScaledMasked(uint16_t duty) { writeAll<true>(duty, std::make_integer_sequence<int, N>{}); }
+
+  // Schrijf 1 kanaal, met weight-mask en overlay
+  void setOneScaledMasked(int i, uint16_t duty) {
+    if (i < 0 || i >= N || !(W[i] > 0.0f)) return;
+    layer.set(i, scaleQ16(i, duty));
+  }
+
+  // Lineaire ramp naar duty (geschaald, gemaskeerd) in ms, zie LedSet::fadeAllScaledMasked
+  void fadeAllScaledMasked(uint16_t duty, uint32_t ms, uint32_t now) {
+    for (int i = 0; i < N; ++i)
+      if (W[i] > 0.0f) layer.fade(i, scaleQ16(i, duty), ms, now);
+  }
+
+  void setAll(uint16_t duty) { // geen weight
+    for (int i = 0; i < N; ++i) layer.set(i, duty);
+  }
+
+  uint16_t maxDuty() const { return layer.maxDuty(); }
+
+  static constexpr int size() { return N; }
+  static constexpr bool selected(int i) { return i >= 0 && i < N && W[i] > 0.0f; }
+  FrameLayer& target() { return layer; }
+
+  uint32_t multiplierQ16(int i) const { return (i >= 0 && i < N) ? mulQ16[i] : 0; }
+
+private:
+  FrameLayer& layer;
+  float overlayFactor = 1.0f;
+  uint32_t mulQ16[N];
+
+  uint16_t scaleQ16(int i, uint16_t duty) const {
+    return (uint16_t)(((uint32_t)duty * mulQ16[i]) >> 16);
+  }
+
+  template <bool Masked, int I>
+  void writeOne(uint16_t duty) {
+    if constexpr (!Masked || W[I] > 0.0f) layer.set(I, scaleQ16(I, duty));
+  }
+
+  template <bool Masked, int... I>
+  void writeAll(uint16_t duty, std::integer_sequence<int, I...>) {
+    (writeOne<Masked, I>(duty), ...);
+  }
+
+  // zelfde formule als LedSet::rebuildMultipliers -> bit-identieke uitvoer
+  void rebuildMultipliers() {
+    for (int i = 0; i < N; ++i) {
+      float f = W[i] * overlayFactor;
+      if (f < 0) f = 0;
+      if (f > 1) f = 1;
+      mulQ16[i] = (uint32_t)(f * 65536.0f + 0.5f);
+    }
+  }
+};
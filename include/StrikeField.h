@@ -0,0 +1,42 @@
+// --- file: StrikeField.h
+#pragma once
+#include "Hal.h"
+#include "Config.h"
+
+// Ruimtelijk model voor ProgThunder: een raster van kOrigins inslagpunten boven de opstelling
+// (Config::LED_POS, STRIKE_HEIGHT_CM erboven, iets ruimer dan de LED's zodat een flits ook van de
+// rand kan komen). Bij het opbouwen wordt per inslagpunt de afstand tot elk kanaal berekend, als
+// extra afstand t.o.v. het dichtstbijzijnde aangestuurde kanaal (weight > 0) in vaste stappen van
+// kCmPerStep (0 = dichtstbij, 255 = zo ver of verder). Vaste stappen: dezelfde cm geven dezelfde
+// vertraging en afzwakking, hoe groot de opstelling ook is. Per burst kiest het programma een
+// inslagpunt en leest vertraging en helderheid per kanaal uit die rij: geen wortels of floats in de
+// frame-lus, O(kanalen) per subflits, kOrigins bytes per kanaal aan geheugen.
+// Eén StrikeField kan gedeeld worden door programma's met dezelfde kanalen en weights.
+class StrikeField
+{
+public:
+    static constexpr int kGrid = 4;                  // inslagpunten per as (x, y)
+    static constexpr int kOrigins = kGrid * kGrid;
+    static constexpr float kCmPerStep = 2.0f;        // 255 stappen = 5 m
+    // Config::STRIKE_SPREAD_CM in stappen: zoveel verder weg = volle spreiding en STRIKE_FALLOFF
+    static constexpr uint32_t kSpreadSteps = (uint32_t)(Config::STRIKE_SPREAD_CM / kCmPerStep + 0.5f);
+
+    // pos = nullptr: kanalen op een rechte lijn (10 cm uit elkaar).
+    // weights = die van de LedSet: kanalen met weight 0 tellen niet mee voor het nulpunt; nullptr = alle.
+    StrikeField(const Config::LedPos* pos, int count, const float* weights = nullptr);
+    ~StrikeField() { delete[] table; }
+    StrikeField(const StrikeField&) = delete;
+    StrikeField& operator=(const StrikeField&) = delete;
+
+    int size() const { return n; }
+    // extra afstand van inslagpunt o tot kanaal i in stappen van kCmPerStep
+    uint8_t dist(int o, int i) const { return table[o * n + i]; }
+    const uint8_t* row(int o) const { return &table[o * n]; }
+    const Config::LedPos& origin(int o) const { return origins[o]; }
+    size_t tableBytes() const { return (size_t)kOrigins * n; }
+
+private:
+    int n;
+    uint8_t* table;                       // kOrigins x n
+    Config::LedPos origins[kOrigins];
+};
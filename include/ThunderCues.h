@@ -0,0 +1,26 @@
+// --- file: ThunderCues.h
+#pragma once
+#include "Hal.h"
+
+// Per-track tijdlijn van donderklappen, als compacte binaire tabel in flash (const -> .rodata).
+// Eén cue = 4 bytes:
+//   deltaMs   : tijd sinds de vorige cue (eerste cue: sinds start track), max. 65535 ms
+//   intensity : 0..255 van maxDuty; 0 = geen flits (tussencue voor gaten > 65 s)
+//   subs      : aantal subflitsen 1..4
+// De tabellen zelf staan in src/CueData.cpp (met de hand of gegenereerd).
+
+struct ThunderCue {
+    uint16_t deltaMs;
+    uint8_t intensity;
+    uint8_t subs;
+};
+static_assert(sizeof(ThunderCue) == 4, "ThunderCue moet 4 bytes zijn");
+
+struct CueTrack {
+    uint16_t track;            // SV5W-trackindex (zie Config::TRACK_*)
+    uint16_t count;            // aantal cues
+    const ThunderCue* cues;
+};
+
+// nullptr als er voor deze track geen tijdlijn is (dan blijft ProgThunder random)
+const CueTrack* findCueTrack(uint16_t track);
@@ -0,0 +1,76 @@
+// --- file: Transition.h
+#pragma once
+#include "Hal.h"
+#include "Compositor.h"
+#include "WaveTable.h"
+#include "WakeScheduler.h"
+
+// Crossfade tussen twee programmalagen, zonder te blokkeren:
+//  - begin(van, naar, now, ms): beide lagen aan; de bovenste van de twee krijgt de mengfactor als
+//    dekking, de onderste blijft vol. Zo is de uitvoer altijd (1-e)*oud + e*nieuw.
+//  - update(now) elke loop() vóór Compositor::commit(); na afloop gaat de oude laag uit.
+// Beide programma's blijven ondertussen gewoon update() krijgen (main.cpp houdt het oude bij).
+// Een nieuwe begin() tijdens een lopende overgang rondt de vorige eerst direct af.
+class Transition {
+public:
+    explicit Transition(Compositor& c) : comp(c) {}
+
+    void begin(FrameLayer* fromLayer, FrameLayer* toLayer, uint32_t now, uint32_t ms) {
+        finish();
+        from = fromLayer;
+        to = toLayer;
+        if (to) {
+            to->setEnabled(true);
+            to->setOpacity(FrameLayer::kOpaque);
+        }
+        if (!from || !to || from == to || ms == 0) {
+            if (from && from != to) from->setEnabled(false);
+            from = nullptr;
+            return;
+        }
+        from->setEnabled(true);
+        from->setOpacity(FrameLayer::kOpaque);
+        upper = comp.layerIndex(to) > comp.layerIndex(from) ? to : from;
+        startMs = now;
+        durMs = ms;
+        running = true;
+        apply(0);
+    }
+
+    void update(uint32_t now) {
+        if (!running) return;
+        uint32_t t = now - startMs;
+        if (t >= durMs) { finish(); return; }
+        apply((uint16_t)(((uint64_t)t << 16) / durMs));
+    }
+
+    // direct naar de eindtoestand: alleen de nieuwe laag, vol
+    void finish() {
+        if (!running) return;
+        running = false;
+        to->setOpacity(FrameLayer::kOpaque);
+        from->setOpacity(FrameLayer::kOpaque);
+        from->setEnabled(false);
+        from = nullptr;
+    }
+
+    bool active() const { return running; }
+    // tijdens de overgang elke kFrameMs een nieuwe mengfactor (WakeScheduler)
+    static constexpr uint32_t kFrameMs = 10;
+    uint32_t nextWakeIn(uint32_t now) const { (void)now; return running ? kFrameMs : WakeScheduler::kForever; }
+    FrameLayer* outgoing() const { return running ? from : nullptr; }
+
+private:
+    Compositor& comp;
+    FrameLayer* from = nullptr;
+    FrameLayer* to = nullptr;
+    FrameLayer* upper = nullptr;     // de laag die de mengfactor als dekking krijgt
+    uint32_t startMs = 0, durMs = 0;
+    bool running = false;
+
+    // t: voortgang in Q16; zachte S-curve zodat begin en einde niet knikken
+    void apply(uint16_t t) {
+        uint16_t e = Wave::easeInOut(t);
+        upper->setOpacity(upper == to ? e : (uint16_t)(FrameLayer::kOpaque - e));
+    }
+};
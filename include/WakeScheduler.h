@@ -0,0 +1,58 @@
+// --- file: WakeScheduler.h
+#pragma once
+#include "Hal.h"
+
+// Deadline-scheduler per taak (render, I/O): elk onderdeel meldt na zijn werk over hoeveel ms het
+// weer aan de beurt moet zijn (nextWakeIn); de vroegste deadline wint en de taak slaapt tot dan.
+//   gWake.reset(now);
+//   gWake.request(prog.nextWakeIn(now)); gWake.request(sv5w.nextPollIn(now)); ...
+//   gWake.sleep();   // Hal::waitUntil(): blokkeert tot de deadline of een wake-bron (knop, BUSY, UART)
+// Niets hoeft te wachten op een wake-bron: die onderbreken het slapen zelf. kForever = "geen deadline".
+class WakeScheduler {
+public:
+    static constexpr uint32_t kForever = 0xFFFFFFFFu;
+    static constexpr uint32_t kMaxSleepMs = 1000;   // bovengrens per keer (vangnet voor gemiste wakes)
+
+    void reset(uint32_t now) {
+        base = now;
+        delayMs = kMaxSleepMs;
+    }
+
+    // over ms opnieuw aan de beurt (0 = direct weer)
+    void request(uint32_t ms) {
+        if (ms < delayMs) delayMs = ms;
+    }
+
+    // niet vaker dan elke ms (vaste framerate / vangnet tegen een taak die de core niet meer loslaat)
+    void minInterval(uint32_t ms) {
+        if (delayMs < ms) delayMs = ms;
+    }
+
+    // ms van now tot het absolute tijdstip t (0 als t al voorbij is), wrap-veilig
+    static uint32_t until(uint32_t now, uint32_t t) {
+        int32_t d = (int32_t)(t - now);
+        return d > 0 ? (uint32_t)d : 0;
+    }
+
+    uint32_t deadline() const { return base + delayMs; }
+    uint32_t delay() const { return delayMs; }
+
+    // slaap tot de deadline of tot een wake-bron; telt wakes en geslapen tijd
+    void sleep() {
+        ++wakes;
+        if (delayMs == 0) return;
+        uint32_t t0 = Hal::millis();
+        Hal::waitUntil(deadline());
+        slept += Hal::millis() - t0;
+    }
+
+    uint32_t wakeups() const { return wakes; }
+    uint64_t sleptMs() const { return slept; }
+    void resetCounters() { wakes = 0; slept = 0; }
+
+private:
+    uint32_t base = 0;
+    uint32_t delayMs = kMaxSleepMs;
+    uint32_t wakes = 0;
+    uint64_t slept = 0;
+};
@@ -0,0 +1,62 @@
+// --- file: WaveTable.h
+#pragma once
+#include "Hal.h"
+
+// Golftabellen voor programma's die per tick een sinus/easing nodig hebben, zonder sinf().
+// - De tabel wordt compile-time berekend (constexpr, C++17) en staat in flash (.rodata).
+// - Fase = 32-bit accumulator: 2^32 = één volle periode, overloop = exact terug naar 0 (geen drift).
+// - Opzoeken: bovenste 8 bits = index, volgende 16 bits = lineaire interpolatie tussen twee punten.
+// Waarden zijn Q16 "unit": 0 = 0.0, 65535 = 1.0.
+namespace Wave {
+
+constexpr int kBits = 8;
+constexpr int kSize = 1 << kBits;              // punten per periode
+constexpr uint32_t kQuarter = 1u << 30;         // 90 graden
+constexpr double kTwoPi = 6.283185307179586;
+
+// fase-increment voor een hoek in radialen (compile-time; bv. stap per tick)
+constexpr uint32_t phaseFromRadians(double r) {
+    return (uint32_t)(uint64_t)((r / kTwoPi) * 4294967296.0 + 0.5);
+}
+
+namespace detail {
+// Taylorreeks, alleen voor de tabelopbouw; x in [-pi, pi] -> fout < 1e-10
+constexpr double sinTaylor(double x) {
+    double term = x, sum = x;
+    for (int n = 1; n < 13; ++n) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+struct SineTable {
+    uint16_t v[kSize + 1];                       // +1: laatste punt = eerste, interpolatie zonder wrap
+    constexpr SineTable() : v() {
+        for (int i = 0; i <= kSize; ++i) {
+            double x = kTwoPi * i / kSize;
+            if (x > kTwoPi / 2) x -= kTwoPi;
+            double u = 0.5 + 0.5 * sinTaylor(x);  // 0..1
+            v[i] = (uint16_t)(u * 65535.0 + 0.5);
+        }
+    }
+};
+} // namespace detail
+
+// 0.5 + 0.5*sin(2*pi*i/kSize) in Q16
+inline constexpr detail::SineTable kSine{};
+
+// 0.5 + 0.5*sin(fase) in Q16
+inline uint16_t sine01(uint32_t phase) {
+    uint32_t i = phase >> (32 - kBits);
+    int32_t frac = (int32_t)((phase >> (16 - kBits)) & 0xFFFF);
+    int32_t a = kSine.v[i], b = kSine.v[i + 1];
+    return (uint16_t)(a + (((b - a) * frac) >> 16));
+}
+
+// Zachte in/uit-overgang (0.5 - 0.5*cos(pi*t)), t en resultaat in Q16; voor fades
+inline uint16_t easeInOut(uint16_t t) {
+    return sine01(((uint32_t)t << 15) - kQuarter);
+}
+
+} // namespace Wave
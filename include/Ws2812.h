@@ -0,0 +1,85 @@
+// --- file: Ws2812.h
+#pragma once
+#include "Hal.h"
+#include "LedPwm.h"
+
+// WS2812(B)-pulsvorm voor de RMT en de host-sink. Eén bit = één RMT-item (hoog dan laag), MSB eerst,
+// bytes in draadvolgorde (G, R, B per pixel). Tik = 25 ns (APB 80 MHz, klokdeler 2).
+namespace Ws2812 {
+    constexpr uint8_t kClkDiv = 2;
+    constexpr uint32_t kTickNs = 25;
+    constexpr uint16_t kT0H = 16, kT0L = 34;  // 0: 400 ns hoog, 850 ns laag
+    constexpr uint16_t kT1H = 32, kT1L = 18;  // 1: 800 ns hoog, 450 ns laag
+    constexpr uint32_t kBitNs = (kT0H + kT0L) * kTickNs;   // 1250 ns (800 kHz)
+    constexpr uint32_t kResetUs = 300;        // laag na het frame: de pixels nemen de nieuwe kleur over
+
+    // rmt_item32_t: duration0:15 level0:1 duration1:15 level1:1
+    constexpr uint32_t item(uint16_t highTicks, uint16_t lowTicks) {
+        return (uint32_t)highTicks | (1u << 15) | ((uint32_t)lowTicks << 16);
+    }
+    constexpr uint32_t kItem0 = item(kT0H, kT0L);
+    constexpr uint32_t kItem1 = item(kT1H, kT1L);
+
+    // draadtijd van n bytes, zonder reset-pauze
+    constexpr uint32_t frameUs(size_t n) { return (uint32_t)((n * 8 * kBitNs + 999) / 1000); }
+
+    // Bytes -> items zoals de RMT-translator (sample_to_rmt_t) ze vraagt: hele bytes, hoogstens
+    // wanted items. Geeft het aantal gebruikte bytes en geschreven items terug.
+    inline void encode(const uint8_t* src, size_t srcN, uint32_t* items, size_t wanted,
+                      size_t* usedBytes, size_t* itemCount) {
+        size_t i = 0, k = 0;
+        while (i < srcN && k + 8 <= wanted) {
+            uint8_t b = src[i++];
+            for (int bit = 7; bit >= 0; --bit) items[k++] = (b >> bit) & 1 ? kItem1 : kItem0;
+        }
+        *usedBytes = i;
+        *itemCount = k;
+    }
+}
+
+// PwmDriver voor een WS2812-strip: elke pixel is een LedPwmChannel, zodat een LedSet/ProgThunder
+// de strip per pixel aanstuurt.
+//   Mono: kanaal = pixel, duty x tint (bv. blauwwit onweer); Rgb: kanaal = pixel * 3 + {0 R, 1 G, 2 B}.
+// Dubbel gebufferd: write() schrijft in de back-buffer, flush() geeft hem aan de PixelOut en rendert
+// verder in de andere. Is de draad nog bezig, dan wacht flush() niet: het frame blijft staan en de
+// eerstvolgende flush() na de reset-pauze stuurt de dan nieuwste toestand (frames vallen samen).
+class Ws2812Strip : public PwmDriver
+{
+public:
+    enum class Layout : uint8_t { Mono, Rgb };
+
+    Ws2812Strip(Hal::PixelOut& out, int pixels, Layout layout = Layout::Mono);
+    ~Ws2812Strip() { delete[] buf[0]; delete[] buf[1]; }
+    Ws2812Strip(const Ws2812Strip&) = delete;
+    Ws2812Strip& operator=(const Ws2812Strip&) = delete;
+
+    void setTint(uint8_t r, uint8_t g, uint8_t b) { tint[0] = g; tint[1] = r; tint[2] = b; } // Mono
+    int pixels() const { return count; }
+    int channels() const { return layout == Layout::Mono ? count : count * 3; }
+    size_t frameBytes() const { return (size_t)count * 3; }
+
+    void setup(int ch, int pin, uint32_t freq, uint8_t resBits) override;
+    void write(int ch, uint32_t duty) override;
+    void flush() override;
+    bool pending() const override { return dirty; }
+    int traceBase() const override { return DutyTrace::kBaseWs2812; }
+
+    // back-buffer (wat de volgende send() wordt), draadvolgorde GRB
+    const uint8_t* frame() const { return buf[back]; }
+
+    // tellers
+    uint32_t framesSent() const { return sent; }
+    uint32_t framesMerged() const { return merged; }   // flush() terwijl de draad bezig was
+    uint32_t sendErrors() const { return errors; }
+
+private:
+    Hal::PixelOut& out;
+    int count;
+    Layout layout;
+    uint8_t resBits = 12;
+    uint8_t tint[3] = { 255, 255, 255 };  // G, R, B
+    uint8_t* buf[2];
+    int back = 0;
+    bool dirty = false;
+    uint32_t sent = 0, merged = 0, errors = 0;
+};
@@ -1,40 +1,85 @@
 // --- file: Button.cpp
 #include "Button.h"
+#include "WakeScheduler.h"
 
-Button::Button(int p, bool aLow) : pin(p), activeLow(aLow), state(false), lastState(false), pressedEvent(false), lastChangeMs(0) {}
+Button::Button(int p, bool aLow, bool repeat) : pin(p), activeLow(aLow), autoRepeat(repeat) {}
 
 void Button::begin()
 {
-    pinMode(pin, INPUT_PULLUP);
+    Hal::pinMode(pin, INPUT_PULLUP);
     state = readRaw();
-    lastState = state;
+    changeMs = Hal::millis() - BTN_DEBOUNCE_MS; // eerste flank meteen door
+    task = Hal::currentTask();
+    timer = Hal::timerCreate("btn", onTimer, this);
+    Hal::attachPinIsr(pin, onEdgeIsr, this);
 }
 
 bool Button::readRaw() const
 {
-    int v = digitalRead(pin);
+    int v = Hal::digitalRead(pin);
     return activeLow ? (v == LOW) : (v == HIGH);
 }
 
-void Button::update(uint32_t now)
+void IRAM_ATTR Button::onEdgeIsr(void* self)
 {
+    Button* b = (Button*)self;
+    b->edgeMs = Hal::millis();
+    b->edges = b->edges + 1;
+    // elke flank schuift de timer op: stuiteren binnen 1 ms levert één callback op
+    Hal::timerArmFromIsr(b->timer, 1);
+}
+
+void Button::onTimer(void* self)
+{
+    ((Button*)self)->settle(Hal::millis());
+}
+
+// Pin en timers bijwerken; draait alleen in de timer-callback
+void Button::settle(uint32_t now)
+{
+    uint32_t seenEdges = edges;
+    uint32_t nextMs = WakeScheduler::kForever;
     bool raw = readRaw();
-    if (raw != lastState && (now - lastChangeMs) >= BTN_DEBOUNCE_MS)
-    {
-        lastState = raw;
-        lastChangeMs = now;
-        state = raw;
-        if (state)
-            pressedEvent = true;
+
+    if (raw != state) {
+        uint32_t lockout = WakeScheduler::until(now, changeMs + BTN_DEBOUNCE_MS);
+        if (lockout == 0) {
+            // buiten de lockout: de flank is echt, direct melden met het tijdstip van de flank
+            state = raw;
+            changeMs = now;
+            push(state ? ButtonEvent::Press : ButtonEvent::Release, edgeMs);
+            holdPending = state;
+            longSent = false;
+            holdAtMs = edgeMs + BTN_LONG_MS;
+            // na de lockout nog eens kijken: een losgelaten knop tijdens het stuiteren mag niet blijven hangen
+            nextMs = BTN_DEBOUNCE_MS;
+        } else {
+            nextMs = lockout; // in de lockout: beslissen zodra die voorbij is
+        }
+    }
+
+    if (state && holdPending) {
+        uint32_t hold = WakeScheduler::until(now, holdAtMs);
+        if (hold == 0) {
+            push(longSent ? ButtonEvent::Repeat : ButtonEvent::LongPress, now);
+            longSent = true;
+            holdPending = autoRepeat;
+            holdAtMs = now + BTN_REPEAT_MS;
+            hold = BTN_REPEAT_MS;
+        }
+        if (holdPending && hold < nextMs) nextMs = hold;
     }
+
+    if (nextMs != WakeScheduler::kForever) Hal::timerArm(timer, nextMs);
+    // een flank tijdens deze callback kan zijn 1 ms-timer net door ons armen kwijt zijn: opnieuw kijken
+    if (edges != seenEdges) Hal::timerArm(timer, 1);
 }
 
-bool Button::consumePressed()
+void Button::push(ButtonEvent::Kind kind, uint32_t ms)
 {
-    if (pressedEvent)
-    {
-        pressedEvent = false;
-        return true;
+    if (!events.push({ kind, ms })) {
+        ++droppedEvents;
+        return;
     }
-    return false;
-}
\ No newline at end of file
+    Hal::wake(task);
+}
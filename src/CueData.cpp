@@ -0,0 +1,24 @@
+// --- file: CueData.cpp
+// Cue-tijdlijnen per audiotrack (formaat: zie ThunderCues.h).
+// Standaard leeg: zonder tijdlijn kiest ProgThunder zijn eigen random ritme. Een verzonnen tijdlijn
+// zou over de echte audio heen flitsen; genereer hem met tools/cuegen uit je eigen tracks.
+// Met de hand kan ook, bv. voor Config::TRACK_THUNDER:
+//   static const ThunderCue CUES_THUNDER[] = {
+//       { 2400, 235, 3 },   // 2,4 s na de start van de track: felle klap, 3 subflitsen
+//       { 6150, 140, 1 },   // 6,15 s later: zwakke, enkele flits
+//   };
+//   en in CUE_TRACKS: { Config::TRACK_THUNDER, sizeof(CUES_THUNDER) / sizeof(CUES_THUNDER[0]), CUES_THUNDER },
+#include "ThunderCues.h"
+#include "Config.h"
+
+static const CueTrack CUE_TRACKS[] = {
+    { 0, 0, nullptr }, // lege array mag niet
+};
+
+const CueTrack* findCueTrack(uint16_t track)
+{
+    for (const CueTrack& t : CUE_TRACKS)
+        if (t.track == track && t.count > 0)
+            return &t;
+    return nullptr;
+}
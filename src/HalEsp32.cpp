@@ -0,0 +1,111 @@
+// --- file: HalEsp32.cpp
+// ESP32-kant van Hal::waitUntil(): een taak slaapt op zijn FreeRTOS task-notificatie.
+// Wake-bronnen (GPIO-interrupt, UART-event, wake()) geven de notificatie aan de taak die ze
+// registreerde; de time-out is de deadline.
+// Daarnaast pin-ISR's, one-shot FreeRTOS software-timers (knop-debounce, zie Button.cpp) en de
+// RMT-zender voor WS2812-strips.
+#ifndef HAL_NATIVE
+#include "Hal.h"
+#include "Ws2812.h"
+#include <driver/rmt.h>
+
+namespace {
+    void IRAM_ATTR onWakeIsr(void* task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR((TaskHandle_t)task, &woken);
+        if (woken) portYIELD_FROM_ISR();
+    }
+
+    // callback + argument achter een FreeRTOS-timer (timer-ID)
+    struct TimerSlot { void (*fn)(void*); void* arg; };
+
+    void onTimer(TimerHandle_t t) {
+        TimerSlot* s = (TimerSlot*)pvTimerGetTimerID(t);
+        s->fn(s->arg);
+    }
+
+    TickType_t IRAM_ATTR toTicks(uint32_t ms) {
+        TickType_t ticks = pdMS_TO_TICKS(ms);
+        return ticks ? ticks : 1; // periode 0 is ongeldig: minstens één tick
+    }
+
+    // RMT-translator: de driver vraagt per halve RMT-geheugenblok nieuwe items (ping-pong in zijn ISR)
+    void ws2812Translate(const void* src, rmt_item32_t* dest, size_t srcSize, size_t wanted,
+                         size_t* translated, size_t* itemNum) {
+        if (!src || !dest) { *translated = 0; *itemNum = 0; return; }
+        Ws2812::encode((const uint8_t*)src, srcSize, (uint32_t*)dest, wanted, translated, itemNum);
+    }
+}
+
+namespace Hal {
+
+TaskRef currentTask() { return xTaskGetCurrentTaskHandle(); }
+
+void waitUntil(uint32_t deadlineMs) {
+    int32_t ms = (int32_t)(deadlineMs - ::millis());
+    if (ms <= 0) return;
+    // pdTRUE: alle wakes sinds de vorige keer tellen als één; een wake die al klaarstaat keert direct terug
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((uint32_t)ms));
+}
+
+void wake(TaskRef task) {
+    if (task) xTaskNotifyGive((TaskHandle_t)task);
+}
+
+void wakeOnPin(int pin) {
+    attachInterruptArg(digitalPinToInterrupt(pin), onWakeIsr, xTaskGetCurrentTaskHandle(), CHANGE);
+}
+
+void wakeOnReceive(HardwareSerial& port) {
+    // draait in de UART-eventtaak van de core, niet in een ISR
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    port.onReceive([task]() { xTaskNotifyGive(task); });
+}
+
+void attachPinIsr(int pin, void (*isr)(void*), void* arg) {
+    attachInterruptArg(digitalPinToInterrupt(pin), isr, arg, CHANGE);
+}
+
+TimerRef timerCreate(const char* name, void (*fn)(void*), void* arg) {
+    TimerSlot* s = new TimerSlot{ fn, arg };  // eenmalig bij het opstarten, leeft voor altijd
+    return xTimerCreate(name, 1, pdFALSE, s, onTimer);
+}
+
+void timerArm(TimerRef t, uint32_t ms) {
+    // xTimerChangePeriod start een slapende timer ook; wachttijd 0: de timer-queue loopt niet vol
+    xTimerChangePeriod((TimerHandle_t)t, toTicks(ms), 0);
+}
+
+void IRAM_ATTR timerArmFromIsr(TimerRef t, uint32_t ms) {
+    BaseType_t woken = pdFALSE;
+    xTimerChangePeriodFromISR((TimerHandle_t)t, toTicks(ms), &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+bool RmtPixelOut::begin(int pin, int rmtChannel) {
+    rmt_config_t cfg = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, (rmt_channel_t)rmtChannel);
+    cfg.clk_div = Ws2812::kClkDiv;
+    cfg.mem_block_num = 2;    // 128 items: minder ISR-refills per frame
+    if (rmt_config(&cfg) != ESP_OK) return false;
+    if (rmt_driver_install(cfg.channel, 0, 0) != ESP_OK) return false;
+    if (rmt_translator_init(cfg.channel, ws2812Translate) != ESP_OK) return false;
+    ch = rmtChannel;
+    return true;
+}
+
+bool RmtPixelOut::busy() {
+    if (ch < 0) return false;
+    if (rmt_wait_tx_done((rmt_channel_t)ch, 0) != ESP_OK) return true;
+    return (int32_t)(::micros() - latchUntilUs) < 0;
+}
+
+bool RmtPixelOut::send(const uint8_t* data, size_t n) {
+    if (ch < 0 || busy()) return false;
+    // wait_tx_done = false: keert direct terug, de driver leest data tijdens het zenden
+    if (rmt_write_sample((rmt_channel_t)ch, data, n, false) != ESP_OK) return false;
+    latchUntilUs = ::micros() + Ws2812::frameUs(n) + Ws2812::kResetUs;
+    return true;
+}
+
+} // namespace Hal
+#endif // HAL_NATIVE
@@ -1,5 +1,8 @@
 // --- file: LedPwm.cpp
 #include "LedPwm.h"
+#include "DutyTrace.h"
+
+DutyTraceWriter* LedPwmChannel::trace = nullptr;
 
 static inline uint16_t clampU16(int v, int lo, int hi)
 {
@@ -12,28 +15,37 @@ static inline uint16_t clampU16(int v, int lo, int hi)
 
 LedPwmChannel::LedPwmChannel(int channel, int pin,
                              uint32_t freq, uint8_t resBits)
-    : ch(channel), pin(pin), freq(freq), resBits(resBits) {}
+    : drv(&LedcDriver::instance()), ch(channel), pin(pin), freq(freq), resBits(resBits) {}
+
+LedPwmChannel::LedPwmChannel(PwmDriver& driver, int channel, uint32_t freq, uint8_t resBits)
+    : drv(&driver), ch(channel), pin(-1), freq(freq), resBits(resBits) {}
 
 void LedPwmChannel::begin()
 {
-    ledcSetup(ch, freq, resBits);
-    ledcAttachPin(pin, ch);
+    drv->setup(ch, pin, freq, resBits);
+    hwValid = false;
 }
 
-void LedPwmChannel::setDuty(uint16_t duty)
+void LedPwmChannel::writeOut()
 {
-    duty = clampU16(duty, 0, maxDuty());
-    ledcWrite(ch, duty);
+    drv->write(ch, pending);
+    written = pending;
+    hwValid = true;
+    ++issued;
+    if (trace) trace->write(Hal::millis(), drv->traceBase() + ch, pending);
 }
 
 void LedPwmChannel::setFrequency(uint32_t newFreq)
 {
     freq = newFreq;
-    ledcSetup(ch, freq, resBits);
+    drv->setup(ch, pin, freq, resBits);
+    hwValid = false;
 }
 
 void LedPwmChannel::setResolution(uint8_t newResBits)
 {
     resBits = newResBits;
-    ledcSetup(ch, freq, resBits);
+    drv->setup(ch, pin, freq, resBits);
+    pending = clampU16(pending, 0, maxDuty());
+    hwValid = false;
 }
\ No newline at end of file
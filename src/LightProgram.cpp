@@ -5,17 +5,28 @@
 //ProgThunder::ProgThunder(LedPwmChannel &a, LedPwmChannel &b) : ch1(a), ch2(b) {}
 //ProgThunder::ProgThunder(LedSet &set, const float *weights) : leds(set), w(weights) {}
 
+ProgThunder::ProgThunder(LedSet &set, const float *weights, const StrikeField *f)
+    : leds(set), w(weights), field(f)
+{
+    int n = set.size() > 0 ? set.size() : 1;
+    if (!field || field->size() < set.size())
+        field = ownField = new StrikeField(nullptr, n, set.size() > 0 ? weights : nullptr);
+    chOffsetMs = new uint16_t[n]();
+    chGainQ8 = new uint16_t[n];
+    for (int i = 0; i < n; ++i) chGainQ8[i] = 256;
+}
+
 void ProgThunder::setWithSkew(uint16_t duty, uint32_t now) {
     int n = leds.size();
-    if (n > kMaxCh) n = kMaxCh;
 
     for (int i = 0; i < n; ++i) {
+        uint32_t d = ((uint32_t)duty * chGainQ8[i]) >> 8; // zwakker verder van de inslag
         uint32_t chStart = phaseStart + chOffsetMs[i];
         if (now < chStart) {
             // zachte pre-arrival gloed per kanaal
-            setOneMasked(i, (uint16_t)(duty * 0.6f));
+            setOneMasked(i, (uint16_t)(d * 3 / 5));
         } else {
-            setOneMasked(i, duty);
+            setOneMasked(i, (uint16_t)d);
         }
     }
 }
@@ -25,7 +36,7 @@ void ProgThunder::scheduleNextBurst(uint32_t now)
     // Maak timing minder uniform: vaker kort, soms lang (clustered storms)
     float r = rand01();
     uint32_t shortGap = 3500 + (uint32_t)(r * r * 4000); // 0.8..4.8 s met bias naar kort
-    if ((esp_random() % 10) == 0)
+    if (rng.oneIn(10))
     {                                      // 10% kans op langere stilte
         shortGap += randRange(3000, 6000); // +3..6 s extra
     }
@@ -34,19 +45,31 @@ void ProgThunder::scheduleNextBurst(uint32_t now)
 
 void ProgThunder::prepareBurst(uint32_t now)
 {
-    // 1) Kies aantal subflitsen (1..4) en intensiteit per sub
-    subsTotal = 1 + (esp_random() % 4);
+    // 1) Kies aantal subflitsen (1..4); intensiteit en preglow worden random in startBurst gekozen
+    startBurst(now, 1 + (int)rng.below(4), -1.0f, 0);
+}
+
+void ProgThunder::triggerBurst(uint32_t now, uint8_t intensity, uint8_t subs, uint32_t preGlowMs)
+{
+    if (subs < 1) subs = 1;
+    if (subs > kMaxSubs) subs = kMaxSubs;
+    // een cue onderbreekt een lopende random burst: de klap heeft voorrang
+    startBurst(now, subs, intensity / 255.0f, preGlowMs ? preGlowMs : 1);
+}
+
+void ProgThunder::startBurst(uint32_t now, int subs, float base, uint32_t preDur)
+{
+    subsTotal = subs;
     subsIndex = 0;
+    ++bursts;
     uint16_t maxv = leds.maxDuty();
-    
-    int n = leds.size();
-    if (n > kMaxCh) n = kMaxCh;
-    for (int i = 0; i < n; ++i) {
-        chOffsetMs[i] = (uint16_t)randRange(0, 25);
-    }
-    
-    // basisintensiteit 60..100% van max
-    float base = 0.60f + 0.40f * rand01();
+
+    // inslagpunt voor deze burst; refreshOffsets() leidt er de vertraging per kanaal uit af
+    origin = (uint8_t)rng.below(StrikeField::kOrigins);
+
+    // basisintensiteit 60..100% van max (tenzij opgegeven door een cue)
+    if (base < 0.0f)
+        base = 0.60f + 0.40f * rand01();
     for (int i = 0; i < subsTotal; ++i)
     {
         float falloff = 1.0f - 0.20f * i;        // elke sub iets zwakker
@@ -64,11 +87,17 @@ void ProgThunder::prepareBurst(uint32_t now)
     // 3) Start met Preglow naar ~40% van eerste sub
     phase = PreGlow;
     phaseStart = now;
-    uint32_t preDur = randRange(10, 40);
+    if (preDur == 0)
+        preDur = randRange(10, 40);
     phaseEnd = phaseStart + preDur;
     setAllMasked(0);
+    // opbouw naar ~40% van de eerste sub als één ramp (de Compositor mengt hem per frame)
+    leds.fadeAllScaledMasked((uint16_t)(subIntensity[0] * 0.4f), preDur, now);
     // Offsets instellen voor de eerste subflits op basis van de piekintensiteit
     refreshOffsets(subIntensity[0]);
+
+    if (follower)
+        follower->triggerBurst(now, (uint8_t)(base * 255.0f + 0.5f), (uint8_t)subs, preDur);
 }
 
 void ProgThunder::start(uint32_t now)
@@ -80,13 +109,13 @@ void ProgThunder::start(uint32_t now)
 
 void ProgThunder::update(uint32_t now)
 {
-    if (now < nextEventMs && phase == Idle)
+    if (phase == Idle && (cueSync || now < nextEventMs))
         return;
 
     switch (phase)
     {
     case Idle:
-        if (now >= nextEventMs)
+        if (!cueSync && now >= nextEventMs)
         {
             prepareBurst(now);
         }
@@ -106,12 +135,6 @@ void ProgThunder::update(uint32_t now)
             phaseEnd = phaseStart + onDur;
             setWithSkew(subIntensity[0], now); // direct naar volle intensiteit
         }
-        else
-        {
-            float t = (float)(now - phaseStart) / (float)(phaseEnd - phaseStart);
-            uint16_t d = (uint16_t)(t * target);
-            setAllMasked(d);
-        }
         break;
     }
     case FlashOn:
@@ -128,7 +151,6 @@ void ProgThunder::update(uint32_t now)
             phaseEnd = phaseStart + offDur;
             setAllMasked(0);
         }
-        refreshOffsets(subIntensity[subsIndex]);
         break;
     }
 
@@ -146,6 +168,10 @@ void ProgThunder::update(uint32_t now)
                 //uint32_t glowDur = randRange(10, 50);                           // random tijd aan
                 uint32_t glowDur = randRange(30, 200);                           // random tijd aan
                 phaseEnd = phaseStart + glowDur;
+                // echo: soms slaat hij elders in
+                if (rng.oneIn(3))
+                    origin = (uint8_t)rng.below(StrikeField::kOrigins);
+                refreshOffsets(subIntensity[subsIndex]);
             }
             else
             {
@@ -156,6 +182,9 @@ void ProgThunder::update(uint32_t now)
                 //uint32_t glowDur = randRange(70, 150);                           // random nagloeitijd
                 uint32_t glowDur = randRange(100, 500);                           // random nagloeitijd
                 phaseEnd = phaseStart + glowDur;
+                // nagloeien: lineair van afterStartDuty naar 0, als één ramp
+                setAllMasked(afterStartDuty);
+                leds.fadeAllScaledMasked(0, glowDur, now);
             }
         }
         break;
@@ -170,26 +199,33 @@ void ProgThunder::update(uint32_t now)
             setAllMasked(0);
             scheduleNextBurst(now);
         }
-        else
-        {
-            // nagloeien: lineair van afterStartDuty naar 0
-            float t = 1.0f - (float)(now - phaseStart) / (float)(phaseEnd - phaseStart);
-
-            if (t < 0)
-                t = 0;
-            if (t > 1)
-                t = 1;
-            uint16_t d = (uint16_t)(afterStartDuty * t);
-            setAllMasked(d);
-        }
         break;
     }
     }
 }
 
+uint32_t ProgThunder::nextWakeIn(uint32_t now) const
+{
+    switch (phase)
+    {
+    case Idle:
+        // met cue-sync start de CueScheduler de burst; die meldt zijn eigen deadline
+        return cueSync ? WakeScheduler::kForever : WakeScheduler::until(now, nextEventMs);
+    case FlashOn:
+    {
+        // zolang er kanalen nog niet 'aangekomen' zijn (skew) elke ms; daarna pas weer op het einde
+        // van de subflits
+        if (WakeScheduler::until(now, phaseStart + skewEndMs) > 0) return 1;
+        return WakeScheduler::until(now, phaseEnd);
+    }
+    default:
+        // PreGlow/AfterGlow lopen als ramp in de Compositor; FlashOff is stil
+        return WakeScheduler::until(now, phaseEnd);
+    }
+}
+
 void ProgThunder::refreshOffsets(uint16_t intensity) {
   int n = leds.size();
-  if (n > kMaxCh) n = kMaxCh;
 
   // Felheid 0..1 omrekenen o.b.v. PWM-maximum
   float b = 0.0f;
@@ -204,8 +240,18 @@ void ProgThunder::refreshOffsets(uint16_t intensity) {
   uint16_t maxMs = baseMax + extra;
   if (maxMs < minMs + 1) maxMs = minMs + 1; // borging
 
+  // aankomst en helderheid uit de afstandstabel: dichtste kanaal op minMs, STRIKE_SPREAD_CM verder op
+  // maxMs (en daarna evenredig later); de afzwakking loopt tot STRIKE_FALLOFF en blijft daar
+  const uint8_t* dist = field->row(origin);
+  const uint32_t span = maxMs - minMs;
+  const uint32_t fallQ8 = (uint32_t)(Config::STRIKE_FALLOFF * 256.0f + 0.5f);
+  constexpr uint32_t kSpread = StrikeField::kSpreadSteps;
+  skewEndMs = 0;
   for (int i = 0; i < n; ++i) {
-    chOffsetMs[i] = (uint16_t)randRange(minMs, maxMs); // per kanaal random spreiding
+    uint32_t d = dist[i];
+    chOffsetMs[i] = (uint16_t)(minMs + (span * d + kSpread / 2) / kSpread);
+    chGainQ8[i] = (uint16_t)(256 - (fallQ8 * (d < kSpread ? d : kSpread) + kSpread / 2) / kSpread);
+    if ((!w || w[i] > 0.0f) && chOffsetMs[i] > skewEndMs) skewEndMs = chOffsetMs[i];
   }
 }
 
@@ -213,7 +259,7 @@ void ProgThunder::refreshOffsets(uint16_t intensity) {
 // ===== ProgDay =====
 void ProgDay::start(uint32_t now)
 {
-    basePhase = 0.f;
+    basePhase = 0;
     nextUpdate = now;
     sparkle1 = 0;
     sparkle2 = 0;
@@ -224,20 +270,19 @@ void ProgDay::update(uint32_t now)
     if (now < nextUpdate)
         return;
     nextUpdate = now + 10; // ~100 Hz
-    //basePhase += 0.015f; // speed: kleine waarde = langzame golf
-    basePhase += 0.055f;
-    if (basePhase > TwoPi)
-        basePhase -= TwoPi;
-    float p1 = basePhase; // fase voor eerste LED
-    float p2 = basePhase + 1.3f; // offset voor tweede LED
+    //PhaseStep = phaseFromRadians(0.015): kleine waarde = langzame golf
+    basePhase += PhaseStep;
+    uint32_t p1 = basePhase; // fase voor eerste LED
+    uint32_t p2 = basePhase + PhaseOffset2; // offset voor tweede LED
 
     // Schaal naar dynamische resolutie per kanaal
     uint16_t maxv = leds.maxDuty();
-    uint16_t d1 = scale(0.35f + 0.25f*(0.5f+0.5f*sinf(p1)), maxv);
-    uint16_t d2 = scale(0.35f + 0.25f*(0.5f+0.5f*sinf(p2)), maxv);
+    uint16_t d1 = waveDuty(p1, maxv);
+    uint16_t d2 = waveDuty(p2, maxv);
 
     //optionele sparkles
-    if((esp_random()&0xFF)==0) sparkle1=1200; if((esp_random()&0xFF)==1) sparkle2=1200;
+    if((rng.next()&0xFF)==0) sparkle1=1200;
+    if((rng.next()&0xFF)==1) sparkle2=1200;
     if(sparkle1>0){ d1 = (uint16_t)min<uint32_t>(maxv, (uint32_t)d1 + sparkle1); sparkle1-=50; }
     if(sparkle2>0){ d2 = (uint16_t)min<uint32_t>(maxv, (uint32_t)d2 + sparkle2); sparkle2-=50; }
     
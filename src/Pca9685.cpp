@@ -0,0 +1,134 @@
+// --- file: Pca9685.cpp
+#include "Pca9685.h"
+
+namespace {
+    constexpr uint8_t kMode1Restart = 0x80;
+    constexpr uint8_t kMode1Ai = 0x20;       // auto-increment
+    constexpr uint8_t kMode1Sleep = 0x10;
+    constexpr uint8_t kMode2OutDrv = 0x04;   // totem-pole uitgangen (LED-drivers / MOSFET-gates)
+    constexpr uint8_t kFullBit = 0x10;       // bit 4 van ON_H / OFF_H: volledig aan / uit
+}
+
+Pca9685::Pca9685(Hal::I2cBus& b, uint8_t firstAddr, int n)
+    : bus(b), addr0(firstAddr), chips(n < 1 ? 1 : (n > kMaxChips ? kMaxChips : n))
+{
+    for (int c = 0; c < kMaxChips; ++c) { dirtyLo[c] = -1; dirtyHi[c] = -1; }
+}
+
+bool Pca9685::begin(uint32_t pwmFreq)
+{
+    bool ok = true;
+    for (int c = 0; c < chips; ++c) {
+        ok &= writeReg(c, kMode2, kMode2OutDrv);
+        ok &= setFrequency(c, pwmFreq);
+        // alles uit tot het eerste frame
+        for (int i = 0; i < kChannelsPerChip; ++i) duty[c * kChannelsPerChip + i] = 0;
+        dirtyLo[c] = 0;
+        dirtyHi[c] = kChannelsPerChip - 1;
+    }
+    freqHz = pwmFreq;
+    flush();
+    return ok;
+}
+
+uint8_t Pca9685::prescaleFor(uint32_t freq)
+{
+    if (freq == 0) freq = 1;
+    uint32_t p = (kOscHz + 2048u * freq) / (4096u * freq); // afgerond
+    p = p > 0 ? p - 1 : 0;
+    if (p < 3) p = 3;
+    if (p > 255) p = 255;
+    return (uint8_t)p;
+}
+
+void Pca9685::encode(uint16_t duty12, uint16_t phase, uint8_t out[4])
+{
+    if (duty12 == 0) {                       // volledig uit
+        out[0] = 0; out[1] = 0; out[2] = 0; out[3] = kFullBit;
+    } else if (duty12 >= 4095) {             // volledig aan
+        out[0] = 0; out[1] = kFullBit; out[2] = 0; out[3] = 0;
+    } else {
+        uint16_t on = phase & 0x0FFF;
+        uint16_t off = (uint16_t)((on + duty12) & 0x0FFF);
+        out[0] = (uint8_t)on; out[1] = (uint8_t)(on >> 8);
+        out[2] = (uint8_t)off; out[3] = (uint8_t)(off >> 8);
+    }
+}
+
+void Pca9685::setup(int ch, int pin, uint32_t freq, uint8_t bits)
+{
+    (void)pin;
+    if (ch < 0 || ch >= channels()) return;
+    resBits[ch] = bits;
+    // één frequentie per bord: een kanaal dat iets anders vraagt zet hem voor het hele bord
+    if (freq && freq != freqHz) {
+        freqHz = freq;
+        for (int c = 0; c < chips; ++c) setFrequency(c, freq);
+    }
+}
+
+void Pca9685::write(int ch, uint32_t d)
+{
+    if (ch < 0 || ch >= channels()) return;
+    // naar 12 bit (LedPwmChannel mag een andere resolutie hebben)
+    uint8_t bits = resBits[ch] ? resBits[ch] : 12;
+    uint32_t maxv = (1u << bits) - 1u;
+    uint16_t d12 = bits == 12 ? (uint16_t)d : (uint16_t)((d * 4095u + maxv / 2) / maxv);
+    if (d12 > 4095) d12 = 4095;
+    duty[ch] = d12;
+    int c = ch / kChannelsPerChip, i = ch % kChannelsPerChip;
+    if (dirtyLo[c] < 0 || i < dirtyLo[c]) dirtyLo[c] = (int8_t)i;
+    if (i > dirtyHi[c]) dirtyHi[c] = (int8_t)i;
+}
+
+void Pca9685::flush()
+{
+    uint8_t buf[1 + 4 * kChannelsPerChip];
+    for (int c = 0; c < chips; ++c) {
+        if (dirtyLo[c] < 0) continue;
+        int lo = dirtyLo[c], hi = dirtyHi[c];
+        size_t n = 0;
+        buf[n++] = (uint8_t)(kLed0OnL + 4 * lo);
+        for (int i = lo; i <= hi; ++i) {
+            // aan-flanken over de periode gespreid: uitgang i begint op i/16 van de PWM-periode
+            encode(duty[c * kChannelsPerChip + i], (uint16_t)(i * (4096 / kChannelsPerChip)), &buf[n]);
+            n += 4;
+        }
+        ++txCount;
+        txBytes += n;
+        if (!bus.write(address(c), buf, n)) {
+            ++txErrors;
+            continue; // bereik blijft staan: de volgende flush() probeert het opnieuw
+        }
+        dirtyLo[c] = -1;
+        dirtyHi[c] = -1;
+    }
+}
+
+bool Pca9685::pending() const
+{
+    for (int c = 0; c < chips; ++c)
+        if (dirtyLo[c] >= 0) return true;
+    return false;
+}
+
+bool Pca9685::writeReg(int chip, uint8_t reg, uint8_t value)
+{
+    uint8_t b[2] = { reg, value };
+    ++txCount;
+    txBytes += 2;
+    bool ok = bus.write(address(chip), b, 2);
+    if (!ok) ++txErrors;
+    return ok;
+}
+
+// PRE_SCALE mag alleen in SLEEP geschreven worden; daarna de oscillator laten starten (500 us) en RESTART
+bool Pca9685::setFrequency(int chip, uint32_t freq)
+{
+    bool ok = writeReg(chip, kMode1, kMode1Sleep | kMode1Ai);
+    ok &= writeReg(chip, kPreScale, prescaleFor(freq));
+    ok &= writeReg(chip, kMode1, kMode1Ai);
+    Hal::delay(1);
+    ok &= writeReg(chip, kMode1, kMode1Restart | kMode1Ai);
+    return ok;
+}
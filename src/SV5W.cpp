@@ -1,7 +1,225 @@
 // --- file: SV5W.cpp
 #include "SV5W.h"
-// (Implementation is header-only for simplicity.)
-// If you prefer a separate compilation unit, move method bodies here.
+// Commando-helpers staan in de header; hier de TX-queue en de RX-state machine.
 
+SV5W::TxEntry* SV5W::pushEntry()
+{
+  if (txCount_ >= kQueueMax) {
+    ++dropped_;
+    return nullptr;
+  }
+  TxEntry* e = &txq_[(txHead_ + txCount_) % kQueueMax];
+  ++txCount_;
+  e->size = 0;
+  e->gapMs = 0;
+  e->query = false;
+  e->cb = nullptr;
+  e->ctx = nullptr;
+  return e;
+}
 
+bool SV5W::enqueue(Command cmd, const uint8_t* data, uint8_t len, bool query, ResponseCallback cb, void* ctx)
+{
+  if (!query && coalesce(cmd, data, len))
+    return true; // opgegaan in een wachtend commando
+  TxEntry* e = pushEntry();
+  if (!e) {
+    if (query && cb) { Response r; r.cmd = (uint8_t)cmd; cb(r, ctx); } // meteen als mislukt melden
+    return false;
+  }
+  const uint8_t start = 0xAA; //Start byte SV5W command
+  const uint8_t c = (uint8_t)cmd;
+  uint8_t checksum = start + c + len;
+  e->bytes[0] = start;
+  e->bytes[1] = c;
+  e->bytes[2] = len;
+  for (uint8_t i = 0; i < len; ++i) {
+    checksum += data[i];
+    e->bytes[3 + i] = data[i];
+  }
+  e->bytes[3 + len] = checksum; // low 8 bits
+  e->size = (uint16_t)(4 + len);
+  e->query = query;
+  e->cb = cb;
+  e->ctx = ctx;
+  return true;
+}
 
+bool SV5W::gap(uint16_t ms)
+{
+  if (txCount_ > 0) {
+    TxEntry& last = entryAt(txCount_ - 1);
+    if (last.size > 0) { last.gapMs += ms; return true; }
+  }
+  TxEntry* e = pushEntry();
+  if (!e) return false;
+  e->gapMs = ms;
+  return true;
+}
+
+void SV5W::removeAt(size_t k)
+{
+  if (k >= txCount_) return;
+  framesElided_ += entryAt(k).size ? 1 : 0;
+  bytesSaved_ += entryAt(k).size;
+  for (size_t i = k + 1; i < txCount_; ++i) entryAt(i - 1) = entryAt(i);
+  --txCount_;
+}
+
+namespace {
+  bool isVolumeCmd(uint8_t c) {
+    return c == (uint8_t)SV5W::Command::SET_VOLUME || c == (uint8_t)SV5W::Command::VOL_UP ||
+           c == (uint8_t)SV5W::Command::VOL_DOWN;
+  }
+  bool isTransportCmd(uint8_t c) {
+    switch ((SV5W::Command)c) {
+      case SV5W::Command::PLAY: case SV5W::Command::PAUSE: case SV5W::Command::STOP:
+      case SV5W::Command::STOP_PLAYING: case SV5W::Command::NEXT: case SV5W::Command::PREVIOUS:
+      case SV5W::Command::NEXT_FILE: case SV5W::Command::PREVIOUS_FILE:
+      case SV5W::Command::SPECIFIED_SONG: case SV5W::Command::SPECIFIED_PATH:
+      case SV5W::Command::SELECT_NO_PLAY:
+        return true;
+      default:
+        return false;
+    }
+  }
+  // absolute transportcommando's: resultaat hangt niet af van wat ervoor gestuurd is
+  bool isAbsoluteTransportCmd(uint8_t c) {
+    switch ((SV5W::Command)c) {
+      case SV5W::Command::STOP: case SV5W::Command::STOP_PLAYING:
+      case SV5W::Command::SPECIFIED_SONG: case SV5W::Command::SPECIFIED_PATH:
+      case SV5W::Command::SELECT_NO_PLAY:
+        return true;
+      default:
+        return false;
+    }
+  }
+  bool isLastWinsSetting(uint8_t c) {
+    return c == (uint8_t)SV5W::Command::SET_EQ || c == (uint8_t)SV5W::Command::SET_LOOP_MODE ||
+           c == (uint8_t)SV5W::Command::SET_CYCLE_TIMES || c == (uint8_t)SV5W::Command::SWITCH_SPECIFIED_DRIVE;
+  }
+}
+
+bool SV5W::coalesce(Command cmd, const uint8_t* data, uint8_t len)
+{
+  (void)data; (void)len;
+  if (!coalesce_) return false;
+  const uint8_t c = (uint8_t)cmd;
+
+  // VOL_UP/DOWN: verwerk in een wachtende SET_VOLUME (zelfde resultaat, één frame minder)
+  if (cmd == Command::VOL_UP || cmd == Command::VOL_DOWN) {
+    for (size_t k = txCount_; k-- > 0;) {
+      TxEntry& e = entryAt(k);
+      if (e.query) break;
+      if (e.size == 0 || e.bytes[1] != (uint8_t)Command::SET_VOLUME) continue;
+      uint8_t v = e.bytes[3];
+      if (cmd == Command::VOL_UP && v < 30) ++v;
+      if (cmd == Command::VOL_DOWN && v > 0) --v;
+      e.bytes[3] = v;
+      e.bytes[4] = (uint8_t)(0xAA + e.bytes[1] + e.bytes[2] + v);
+      ++framesElided_;
+      bytesSaved_ += 4;
+      return true;
+    }
+    return false;
+  }
+
+  // Wachtende commando's die door het nieuwe commando achterhaald zijn verwijderen
+  for (size_t k = txCount_; k-- > 0;) {
+    const TxEntry& e = entryAt(k);
+    if (e.query) break;
+    if (e.size == 0) continue;
+    const uint8_t old = e.bytes[1];
+    bool superseded =
+        (cmd == Command::SET_VOLUME && isVolumeCmd(old)) ||
+        (isLastWinsSetting(c) && old == c) ||
+        (isAbsoluteTransportCmd(c) && isTransportCmd(old));
+    if (superseded) removeAt(k);
+  }
+  return false;
+}
+
+void SV5W::transmit(const TxEntry& e, uint32_t now)
+{
+  for (uint16_t i = 0; i < e.size; ++i) serial_->write(e.bytes[i]);
+  bytesSent_ += e.size;
+  ++framesSent_;
+  // draadtijd: 10 bits per byte (8N1), naar boven afgerond
+  uint32_t wireMs = (uint32_t)((e.size * 10u * 1000u + baud_ - 1) / baud_);
+  nextTxMs_ = now + wireMs + e.gapMs;
+  if (e.query) {
+    awaiting_ = true;
+    awaitCmd_ = e.bytes[1];
+    awaitCb_ = e.cb;
+    awaitCtx_ = e.ctx;
+    sentAtMs_ = now;
+  }
+  if (sentCb_) sentCb_((Command)e.bytes[1], now, sentCtx_);
+}
+
+void SV5W::poll(uint32_t now)
+{
+  if (!serial_) return;
+
+  // 1) RX: alles wat er nu ligt door de parser
+  while (serial_->available() > 0) {
+    int b = serial_->read();
+    if (b < 0) break;
+    rxByte((uint8_t)b);
+  }
+
+  // 2) lopende query verlopen?
+  if (awaiting_ && (now - sentAtMs_) >= timeoutMs_) {
+    awaiting_ = false;
+    ++timeouts_;
+    rxStage_ = 0; // half frame weggooien
+    if (awaitCb_) { Response r; r.cmd = awaitCmd_; awaitCb_(r, awaitCtx_); }
+  }
+
+  // 3) TX: één item per keer, pas als de lijn vrij is en er geen antwoord meer verwacht wordt
+  while (!awaiting_ && txCount_ > 0 && (int32_t)(now - nextTxMs_) >= 0) {
+    const TxEntry& e = txq_[txHead_];
+    txHead_ = (txHead_ + 1) % kQueueMax;
+    --txCount_;
+    if (e.size == 0) {                // wachttijd
+      nextTxMs_ = now + e.gapMs;
+      continue;
+    }
+    transmit(e, now);
+  }
+}
+
+void SV5W::rxByte(uint8_t b)
+{
+  switch (rxStage_) {
+    case 0: // wait for start byte
+      if (b == 0xAA) { rxSum_ = b; rxStage_ = 1; }
+      break;
+    case 1: // read command
+      rxCmd_ = b; rxSum_ += b; rxStage_ = 2; break;
+    case 2: // read length
+      rxLen_ = b; rxSum_ += b; rxPos_ = 0; rxStage_ = (rxLen_ == 0 ? 4 : 3); break;
+    case 3: // read data bytes
+      rx_.data[rxPos_++] = b; rxSum_ += b;
+      if (rxPos_ == rxLen_) rxStage_ = 4;
+      break;
+    case 4: // read checksum
+      rx_.cmd = rxCmd_;
+      rx_.valid = (b == rxSum_);
+      rx_.len = rx_.valid ? rxLen_ : 0;
+      if (!rx_.valid) ++rxErrors_;
+      rxStage_ = 0;
+      frameReceived(rx_);
+      break;
+  }
+}
+
+void SV5W::frameReceived(const Response& r)
+{
+  if (awaiting_ && r.cmd == awaitCmd_) {
+    awaiting_ = false;
+    if (awaitCb_) awaitCb_(r, awaitCtx_);
+    return;
+  }
+  if (r.valid && unsolicitedCb_) unsolicitedCb_(r, unsolicitedCtx_);
+}
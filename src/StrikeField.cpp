@@ -0,0 +1,52 @@
+// --- file: StrikeField.cpp
+#include "StrikeField.h"
+
+namespace {
+    constexpr float kMargin = 0.25f;   // inslagpunten tot 25% buiten de opstelling
+    constexpr float kLinePitchCm = 10.0f; // pos = nullptr: kanalen op een lijn, zoveel cm uit elkaar
+
+    Config::LedPos posOf(const Config::LedPos* pos, int i) {
+        return pos ? pos[i] : Config::LedPos{ i * kLinePitchCm, 0.0f, 0.0f };
+    }
+
+    float distance(const Config::LedPos& a, const Config::LedPos& b) {
+        float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+        return sqrtf(dx * dx + dy * dy + dz * dz);
+    }
+}
+
+StrikeField::StrikeField(const Config::LedPos* pos, int count, const float* weights)
+    : n(count > 0 ? count : 1), table(new uint8_t[(size_t)kOrigins * (count > 0 ? count : 1)])
+{
+    // omhullende van de opstelling
+    Config::LedPos lo = posOf(pos, 0), hi = lo;
+    for (int i = 1; i < count; ++i) {
+        Config::LedPos p = posOf(pos, i);
+        lo.x = min(lo.x, p.x); hi.x = max(hi.x, p.x);
+        lo.y = min(lo.y, p.y); hi.y = max(hi.y, p.y);
+        hi.z = max(hi.z, p.z);
+    }
+    float mx = (hi.x - lo.x) * kMargin, my = (hi.y - lo.y) * kMargin;
+    lo.x -= mx; hi.x += mx;
+    lo.y -= my; hi.y += my;
+
+    // raster van inslagpunten (celmiddens) boven de hoogste LED
+    for (int gy = 0; gy < kGrid; ++gy)
+        for (int gx = 0; gx < kGrid; ++gx)
+            origins[gy * kGrid + gx] = { lo.x + (hi.x - lo.x) * (gx + 0.5f) / kGrid,
+                                         lo.y + (hi.y - lo.y) * (gy + 0.5f) / kGrid,
+                                         hi.z + Config::STRIKE_HEIGHT_CM };
+
+    // per inslagpunt: nulpunt = dichtstbijzijnde aangestuurde kanaal, daarna vaste stappen
+    // (twee passen, geen tijdelijke buffer)
+    for (int o = 0; o < kOrigins; ++o) {
+        float dMin = 1e30f;
+        for (int i = 0; i < count; ++i)
+            if (!weights || weights[i] > 0.0f) dMin = min(dMin, distance(origins[o], posOf(pos, i)));
+        uint8_t* r = &table[o * n];
+        for (int i = 0; i < n; ++i) {
+            float steps = i < count ? (distance(origins[o], posOf(pos, i)) - dMin) / kCmPerStep : 0.0f;
+            r[i] = steps <= 0.0f ? 0 : steps >= 255.0f ? 255 : (uint8_t)(steps + 0.5f);
+        }
+    }
+}
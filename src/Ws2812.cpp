@@ -0,0 +1,51 @@
+// --- file: Ws2812.cpp
+#include "Ws2812.h"
+
+namespace {
+    constexpr uint8_t kWireOffset[3] = { 1, 0, 2 }; // R, G, B -> positie in GRB
+}
+
+Ws2812Strip::Ws2812Strip(Hal::PixelOut& o, int n, Layout l)
+    : out(o), count(n > 0 ? n : 1), layout(l)
+{
+    for (int k = 0; k < 2; ++k) {
+        buf[k] = new uint8_t[frameBytes()];
+        memset(buf[k], 0, frameBytes());
+    }
+    dirty = true; // eerste flush() zet de strip op zwart
+}
+
+void Ws2812Strip::setup(int ch, int pin, uint32_t freq, uint8_t bits)
+{
+    (void)ch; (void)pin; (void)freq; // vaste 800 kHz-draad
+    resBits = bits;
+}
+
+void Ws2812Strip::write(int ch, uint32_t duty)
+{
+    if (ch < 0 || ch >= channels()) return;
+    uint32_t maxv = (1u << resBits) - 1u;
+    if (duty > maxv) duty = maxv;
+    uint8_t* p = buf[back];
+    if (layout == Layout::Mono) {
+        p += ch * 3;
+        for (int c = 0; c < 3; ++c) p[c] = (uint8_t)((duty * tint[c] + maxv / 2) / maxv);
+    } else {
+        p[(ch / 3) * 3 + kWireOffset[ch % 3]] = (uint8_t)((duty * 255u + maxv / 2) / maxv);
+    }
+    dirty = true;
+}
+
+void Ws2812Strip::flush()
+{
+    if (!dirty) return;
+    if (out.busy()) { ++merged; return; }  // niet wachten: volgende frame probeert het weer
+    if (!out.send(buf[back], frameBytes())) { ++errors; return; }
+    ++sent;
+    dirty = false;
+    // de verzonden buffer is van de zender tot busy() false is; verder in de andere, met dezelfde inhoud
+    // (LedPwmChannel schrijft alleen wijzigingen)
+    int front = back;
+    back ^= 1;
+    memcpy(buf[back], buf[front], frameBytes());
+}
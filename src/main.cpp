@@ -5,11 +5,20 @@
 #include "SV5W.h"
 #include "Button.h"
 #include "LedPwm.h"
+#include "Pca9685.h" // optionele I2C-PWM-borden i.p.v. LEDC
+#include "Ws2812.h" // optionele pixelstrip (RMT)
 #include "LightProgram.h"
 #include "Config.h"
 #include "LedSet.h"
+#include "StaticLedSet.h" // blink-set met compile-time masker
+#include "Compositor.h" // per-frame mengen van programma- en overlaylagen
+#include "Transition.h" // crossfade tussen modi
 #include "BlinkOverlay.h" // voor knipper-overlay
 #include "LaternController.h" // voor lantaarnpalen aansturing
+#include "LoopProfiler.h" // loop-timing en jitter (serial: stats)
+#include "CueScheduler.h" // flitsen synchroon met de donderklappen in de track
+#include "WakeScheduler.h" // taken slapen tot hun eerstvolgende deadline
+#include "SpscRing.h" // opdrachten van de I/O-taak naar de render-taak
 
 /*
 // ======= CONDITIONELE INCLUDES =======
@@ -29,7 +38,7 @@
 // --- Serial debug: command buffer + volume state
 static char gSerBuf[32];
 static uint8_t gSerLen = 0;
-static uint8_t gVolume = Config::VOLUME_DEFAULT; // gedeeld tussen knoppen & serial
+static uint8_t gVolume = Config::VOLUME_DEFAULT; // alleen I/O-taak (knoppen & serial); de engine gebruikt het niet
 
 // Zorg dat Mode hier al bekend is:
 enum class Mode { 
@@ -39,19 +48,13 @@ enum class Mode {
   NightThunder = 3,
   COUNT //totaal aantal modes
 };
-extern Mode currentMode;
-Mode currentMode = Mode::Thunder; //start met thunder
-
-// Vooruitdeclaraties (staan elders daadwerkelijk gedefinieerd)
-void startMode(Mode m, uint32_t now);
-void nextMode(uint32_t now);
-void prevMode(uint32_t now);
 
 // ===================== Buttons =====================
+// interrupt + timer-debounce; de I/O-taak leest alleen hun event-queues (zie Button.h)
 Button btnNext{Config::PIN_BTN_NEXT,true};
 Button btnPrev{Config::PIN_BTN_PREV,true};
-Button btnVolUp(Config::PIN_BTN_VOL_UP, true);
-Button btnVolDown(Config::PIN_BTN_VOL_DOWN, true);
+Button btnVolUp(Config::PIN_BTN_VOL_UP, true, true);     // vasthouden = auto-repeat
+Button btnVolDown(Config::PIN_BTN_VOL_DOWN, true, true);
 
 
 // ===================== DY-SV5W =====================
@@ -60,7 +63,7 @@ constexpr uint16_t TRACK_THUNDER = Config::TRACK_THUNDER;
 constexpr uint16_t TRACK_DAY = Config::TRACK_DAY; 
 constexpr uint16_t TRACK_NIGHT_CLEAR = Config::TRACK_NIGHT_CLEAR; 
 
-// --- SV5W BUSY monitoring (active LOW)
+// --- SV5W BUSY monitoring (active LOW), alleen I/O-taak; de render-taak krijgt BusyEdge-opdrachten
 static bool busyState = false;               // gefilterde/stabiele staat
 static bool busyRaw   = false;               // laatst gemeten raw
 static uint32_t busyLastEdgeMs = 0;          // laatste raw edge
@@ -89,66 +92,128 @@ static inline void lampsSet(bool on){
 */
 
 
-static BlinkOverlay gBlink; // globale knipper-overlay
-static LanternController gLanterns; // globale lantaarncontroller
+// ===================== Taken =====================
+// Render-taak (Config::RENDER_CORE, hoge prioriteit): modus, cues, programma's, overlays en compositor -> LEDC.
+// I/O-taak (Config::IO_CORE): knoppen, serial, SV5W en BUSY. Trage UART-verkeer of prints houden de
+// flitsen dus niet meer op. De taken delen geen globals; alles gaat via lock-free SPSC-queues:
+//   I/O -> render : RenderCmd (moduswissel, knop NEXT/PREV, play-frame, BUSY-flank, stats)
+//   render -> I/O : RenderEvent (modus gewisseld -> audio + lantaarns) en RenderTelemetry (stats)
+// Na een push wekt de producent de andere taak (Hal::wake).
+struct RenderCmd {
+  enum Kind : uint8_t { SetMode, StepMode, PlaySent, BusyEdge, StatsRequest, ResetStats } kind;
+  int8_t arg;   // SetMode: modus-index, StepMode: +1/-1, BusyEdge: 1 = actief
+  uint32_t ms;  // tijdstip van de gebeurtenis (PlaySent/BusyEdge/StatsRequest)
+};
+struct RenderEvent {
+  enum Kind : uint8_t { ModeChanged } kind;
+  uint8_t mode;
+};
+// Momentopname van de render-kant; gaat als geheel door de queue, dus de I/O-taak leest nooit
+// tellers die de render-taak op hetzelfde moment bijwerkt.
+struct RenderTelemetry {
+  uint32_t atMs = 0;
+  uint8_t mode = 0;
+  LoopProfiler prof;
+  uint32_t dutyRequests = 0, ledcWrites = 0;
+  uint32_t frames = 0;
+  uint32_t bursts = 0, cuesFired = 0, cuesLate = 0;
+  uint32_t wakeups = 0;
+  uint64_t sleptMs = 0;
+  uint32_t eventsDropped = 0;
+};
+static SpscRing<RenderCmd, 16> gToRender;
+static SpscRing<RenderEvent, 8> gFromRender;
+static SpscRing<RenderTelemetry, 2> gTelemetry;
+static uint32_t gRenderCmdsDropped = 0; // queue vol (I/O-kant)
+static uint32_t gRenderEventsDropped = 0; // queue vol (render-kant, gaat mee in de telemetrie)
+static Hal::TaskRef gRenderTask = nullptr;
+static Hal::TaskRef gIoTask = nullptr;
+
+static BlinkOverlay gBlink; // globale knipper-overlay (render)
+static LoopProfiler gRenderProf; // timing per render-frame
+static LoopProfiler gIoProf; // timing per I/O-ronde
+static uint32_t gStatsSinceMs = 0; // begin van het stats-venster (voor bytes/s)
+static CueScheduler gCues; // audio-sync: cue-tijdlijn van de thunder-track (render)
+static bool gRenderBusy = false; // BUSY zoals de render-taak hem via BusyEdge kent
+static WakeScheduler gRenderWake; // vroegste deadline per taak -> slapen tot dan
+static WakeScheduler gIoWake;
+static LanternController gLanterns; // globale lantaarncontroller (I/O)
 
 // Led kanalen:
 static LedPwmChannel* LEDS[Config::LED_COUNT];
+static Hal::WireBus gI2c;        // alleen met Config::LED_USE_PCA9685
+static Pca9685* gPca = nullptr;
+
+// Pixelstrip (Config::WS2812_PIXELS > 0): eigen compositor en onweer per pixel, volgt de thunder-modus
+static Hal::RmtPixelOut gPixelOut;
+static Ws2812Strip* gStrip = nullptr;
+static Compositor* gPixelFrame = nullptr;
+static ProgThunder* gPixelStorm = nullptr;
+static StrikeField* gStrikeField = nullptr; // afstandstabellen van Config::LED_POS, gedeeld door de thunder-modi (zelfde weights)
 
-// LedSets per scenario:
-static LedSet* thunderSetPtr = nullptr;
-static LedSet* daySetPtr     = nullptr;
-static LedSet* blinkSetPtr   = nullptr;
+// Framebuffer: elke LedSet schrijft in een eigen laag, de compositor commit één keer per frame
+static Compositor* gFrame = nullptr;
+static Transition* gTransition = nullptr; // crossfade tussen de lagen van oude en nieuwe modus
+static FrameLayer* blinkLayerPtr   = nullptr;
 
-// Programma’s als pointers:
-static ProgThunder* progThunderPtr = nullptr;
-static ProgDay*     progDayPtr     = nullptr;
+// Blink-set:
+using BlinkSet = StaticLedSet<Config::LED_COUNT, Config::LEDSET_BLINK_WEIGHTS>; // weights liggen vast in Config
+static BlinkSet* blinkSetPtr = nullptr;
 
-// Helpers om bestaande pointers te gebruiken:
-static LightProgram* getThunderProg() { return progThunderPtr; }
-static LightProgram* getDayProg()     { return progDayPtr;     }
+// Soort lichtprogramma per modus
+enum class ProgKind : uint8_t { Thunder, Day };
 
-// Koppel hoofdmodus -> (programma, track, lantern aan/uit)
+// Koppel hoofdmodus -> (programma, weights, track, lantern aan/uit)
 struct ModeSpec {
-  LightProgram* (*progPtrGetter)(); // lazy getter zodat pointers nooit null blijven
+  ProgKind kind;
+  const float* weights; // scenario-weights uit Config
   int audioTrack;
   bool lanternOn;
 };
 
 // Voor Thunder (legacy) kun je die laten wijzen naar thunder-programma + thunder-track
 static const ModeSpec MODE_TABLE[static_cast<int>(Mode::COUNT)] = {
-  /* Thunder            */ { getThunderProg,       TRACK_THUNDER,       false },
-  /* Day                */ { getDayProg,           TRACK_DAY,           false },
-  /* NightClear         */ { getDayProg,           TRACK_NIGHT_CLEAR,   true  },
-  /* NightThunderstorm  */ { getThunderProg,       TRACK_THUNDER,       true  },
+  /* Thunder            */ { ProgKind::Thunder, Config::LEDSET_THUNDER_WEIGHTS, TRACK_THUNDER,       false },
+  /* Day                */ { ProgKind::Day,     Config::LEDSET_DAY_WEIGHTS,     TRACK_DAY,           false },
+  /* NightClear         */ { ProgKind::Day,     Config::LEDSET_DAY_WEIGHTS,     TRACK_NIGHT_CLEAR,   true  },
+  /* NightThunderstorm  */ { ProgKind::Thunder, Config::LEDSET_THUNDER_WEIGHTS, TRACK_THUNDER,       true  },
 };
 
-static inline LedSet* activeSet() {
-  //return (currentMode == Mode::Thunder) ? thunderSetPtr : daySetPtr;
-  switch (currentMode) {
-    case Mode::Thunder:
-    case Mode::Day:
-    case Mode::NightClear:
-    case Mode::NightThunder: return thunderSetPtr;
-    default: return daySetPtr;
+// Per modus een eigen programma op een eigen laag: bij een moduswissel lopen het oude en het
+// nieuwe programma tegelijk, zodat de Transition ze kan mengen (ook Day -> NightClear).
+struct ModeSlot {
+  FrameLayer* layer = nullptr;
+  LedSet* set = nullptr;
+  LightProgram* prog = nullptr;
+  ProgThunder* thunder = nullptr; // != nullptr als prog een ProgThunder is (audio-sync)
+};
+static ModeSlot gSlots[static_cast<int>(Mode::COUNT)];
 
-  }
-}
+// master-seed van deze run: in setup() gezet, daarna alleen gelezen (stats)
+static uint64_t gRngSeed = 0;
 
 LightProgram *currentProg = nullptr;
+static ModeSlot* currentSlot = nullptr;
+static ModeSlot* outgoingSlot = nullptr; // draait door tot de crossfade klaar is
 
-void startMode(Mode m, uint32_t now)
-{
-  // voorkom waarde buiten bereik
-  int n = static_cast<int>(Mode::COUNT);
-  int idx = ((static_cast<int>(m) % n) + n) % n;
-  m = static_cast<Mode>(idx);
+// Opdracht naar de render-taak (alleen vanuit de I/O-taak: één producent)
+static void sendToRender(RenderCmd::Kind kind, int8_t arg, uint32_t ms) {
+  if (!gToRender.push(RenderCmd{kind, arg, ms})) ++gRenderCmdsDropped;
+  Hal::wake(gRenderTask);
+}
 
-  currentMode = m;
+// Gebeurtenis naar de I/O-taak (alleen vanuit de render-taak)
+static void sendToIo(RenderEvent::Kind kind, uint8_t mode) {
+  if (!gFromRender.push(RenderEvent{kind, mode})) ++gRenderEventsDropped;
+  Hal::wake(gIoTask);
+}
 
-  // Audio stoppen en kleine settle
+// I/O-kant van een moduswissel (na ModeChanged van de render-taak): audio en lantaarns
+static void startModeAudio(int idx)
+{
+  // Audio stoppen en kleine settle (in de SV5W-queue, de I/O-taak loopt door)
   sv5w.stop();
-  delay(100);
+  sv5w.gap(100);
 
   // Lookup
   const ModeSpec& spec = MODE_TABLE[idx];
@@ -156,69 +221,58 @@ void startMode(Mode m, uint32_t now)
   // Lantaarns
   gLanterns.set(spec.lanternOn);
 
-  // Audio starten
+  // Audio starten; het play-frame (PlaySent) komt dus altijd na de moduswissel in de render-taak
   sv5w.playTrack(spec.audioTrack);
+}
+
+static Mode gMode = Mode::Thunder; // actieve modus, alleen render-taak
 
-  // Lichtprogramma selecteren
-  currentProg = spec.progPtrGetter();
+// Render-kant van een moduswissel; daarna krijgt de I/O-taak ModeChanged voor audio en lantaarns
+static void startMode(Mode m, uint32_t now)
+{
+  // voorkom waarde buiten bereik
+  int n = static_cast<int>(Mode::COUNT);
+  int idx = ((static_cast<int>(m) % n) + n) % n;
+  gMode = static_cast<Mode>(idx);
+
+  const ModeSpec& spec = MODE_TABLE[idx];
+
+  // Lichtprogramma selecteren; het vorige blijft lopen en fadet uit
+  ModeSlot* prev = currentSlot;
+  currentSlot = &gSlots[idx];
+  currentProg = currentSlot->prog;
+  if (prev && prev->thunder) prev->thunder->setCueSync(false); // geen cues meer: eigen ritme tot het weg is
+  // pixelstrip flitst mee met het onweer van de actieve modus
+  if (prev && prev->thunder) prev->thunder->setFollower(nullptr);
+  if (currentSlot->thunder) currentSlot->thunder->setFollower(gPixelStorm);
   if (currentProg) {
     currentProg->start(now);
   }
-}
+  if (gTransition) {
+    gTransition->begin(prev ? prev->layer : nullptr, currentSlot->layer, now, Config::MODE_CROSSFADE_MS);
+    outgoingSlot = (prev != currentSlot && gTransition->active()) ? prev : nullptr;
+  }
 
+  // Audio-sync: tijdlijn van deze track klaarzetten; anker volgt bij play-frame/BUSY-flank
+  gCues.arm(currentSlot->thunder ? findCueTrack(spec.audioTrack) : nullptr);
 
-void startMode2(Mode m, uint32_t now)
-{
-  currentMode = m;
-  sv5w.stop();
-  delay(100);
-  switch (m)
-  {
-  case Mode::Thunder:
-    sv5w.playTrack(TRACK_THUNDER);
-    currentProg = progThunderPtr;
-    //sv5w.playByPath(0x01, "\\THUNDER\\00001.MP3"); // drive: 0x01 = SD
-    //sv5w.playByPath("\\THUNDER\\00001.MP3"); // gebruikt default drive //Zorg dat de backslash-escapes kloppen in C++-strings (\"\\\\THUNDER\\\\00001.MP3\" in code).
-    //sv5w.playRandomFolderClip("\\THUNDER", /*maxIndex=*/20); //speel random clip uit map THUNDER met bestanden 00001.MP3 .. 00020.MP3
-    break;
-  case Mode::Day:
-    sv5w.playTrack(TRACK_DAY);
-    currentProg = progDayPtr;
-    break;
-  default:
-    sv5w.playTrack(TRACK_THUNDER);
-    currentProg = progThunderPtr;
-    break;
-  }
-  
-  if (currentProg)
-    currentProg->start(now);
+  sendToIo(RenderEvent::ModeChanged, (uint8_t)idx);
 }
 
-//switchen naar volgende/vorige mode, met wrap-around om binnen het aantal modes te blijven
-void nextMode(uint32_t now)
-{
-  int n = (int)Mode::COUNT;
-  int cur = (int)currentMode;
-  cur = (cur + 1) % n;
-  startMode((Mode)cur, now);
-}
-void prevMode(uint32_t now)
+//switchen naar volgende/vorige mode (step +1/-1), met wrap-around via startMode()
+static void stepMode(int step, uint32_t now)
 {
-  int n = (int)Mode::COUNT;
-  int cur = (int)currentMode;
-  cur = (cur - 1 + n) % n;
-  startMode((Mode)cur, now);
+  startMode((Mode)((int)gMode + step), now);
 }
 
 // Zelfde acties als knoppen, maar via Serial
 static void doNext(uint32_t now) {
   Serial.println(F("CMD: NEXT"));
-  nextMode(now);
+  sendToRender(RenderCmd::StepMode, +1, now);
 }
 static void doPrev(uint32_t now) {
   Serial.println(F("CMD: PREV"));
-  prevMode(now);
+  sendToRender(RenderCmd::StepMode, -1, now);
 }
 static void doVolUp() {
   if (gVolume < Config::VOLUME_MAX) {
@@ -245,9 +299,62 @@ static void printHelp() {
   Serial.println(F("  p / prev      -> PREV mode"));
   Serial.println(F("  + / vol+      -> volume up"));
   Serial.println(F("  - / vol-      -> volume down"));
+  Serial.println(F("  stats         -> loop timing per stage"));
+  Serial.println(F("  stats reset   -> reset loop timing"));
   Serial.println(F("  h / help      -> this help"));
 }
 
+static void printProfile(const char* task, const LoopProfiler& prof) {
+  Serial.printf("[%s]\n", task);
+  Serial.println(F("stage     count      avg_us   worst_us  histogram (>=us:count)"));
+  for (int i = 0; i < LoopProfiler::COUNT; ++i) {
+    auto s = (LoopProfiler::Stage)i;
+    const LoopProfiler::Stats& st = prof.stats(s);
+    if (!st.count) continue; // stap hoort bij de andere taak
+    Serial.printf("%-8s %8lu %10lu %10lu ", LoopProfiler::stageName(s),
+                  (unsigned long)st.count, (unsigned long)prof.averageUs(s), (unsigned long)st.worstUs);
+    for (int b = 0; b < LoopProfiler::kBuckets; ++b) {
+      if (st.hist[b]) Serial.printf(" %lu:%lu", (unsigned long)LoopProfiler::bucketFloorUs(b), (unsigned long)st.hist[b]);
+    }
+    Serial.println();
+  }
+}
+
+static void printWake(const char* task, uint32_t wakeups, uint64_t sleptMs, uint32_t windowMs) {
+  Serial.printf("wake %-6s: %lu wakeups (%lu/min), %lu%% van de tijd geslapen\n", task,
+                (unsigned long)wakeups,
+                (unsigned long)(windowMs ? (uint64_t)wakeups * 60000u / windowMs : 0),
+                (unsigned long)(windowMs ? sleptMs * 100u / windowMs : 0));
+}
+
+// Vanuit de I/O-taak, zodra de momentopname van de render-taak binnen is ('stats' -> StatsRequest)
+static void printStats(const RenderTelemetry& t) {
+  printProfile("render", t.prof);
+  printProfile("io", gIoProf);
+
+  Serial.printf("pwm: %lu setDuty, %lu ledcWrite, %lu onderdrukt (%lu frames)\n",
+                (unsigned long)t.dutyRequests, (unsigned long)t.ledcWrites,
+                (unsigned long)(t.dutyRequests > t.ledcWrites ? t.dutyRequests - t.ledcWrites : 0),
+                (unsigned long)t.frames);
+  Serial.printf("modus %u: %lu bursts, cues %lu gevuurd / %lu te laat, seed 0x%016llx\n", (unsigned)t.mode,
+                (unsigned long)t.bursts, (unsigned long)t.cuesFired, (unsigned long)t.cuesLate,
+                (unsigned long long)gRngSeed);
+
+  uint32_t secs = (millis() - gStatsSinceMs) / 1000u;
+  Serial.printf("sv5w: %lu frames / %lu bytes verstuurd, %lu samengevoegd (%lu bytes bespaard, %lu B/s), "
+                "%lu timeouts, %lu rx-fouten, %lu queue vol\n",
+                (unsigned long)sv5w.framesSent(), (unsigned long)sv5w.bytesSent(),
+                (unsigned long)sv5w.framesElided(), (unsigned long)sv5w.bytesSaved(),
+                (unsigned long)(secs ? sv5w.bytesSaved() / secs : sv5w.bytesSaved()),
+                (unsigned long)sv5w.timeouts(), (unsigned long)sv5w.rxErrors(), (unsigned long)sv5w.dropped());
+
+  printWake("render", t.wakeups, t.sleptMs, t.atMs - gStatsSinceMs);
+  printWake("io", gIoWake.wakeups(), gIoWake.sleptMs(), millis() - gStatsSinceMs);
+  Serial.printf("queues: %lu opdrachten / %lu gebeurtenissen verloren (vol)\n",
+                (unsigned long)gRenderCmdsDropped, (unsigned long)t.eventsDropped);
+}
+
+
 static void processSerialCmd(const char* cmd, uint32_t now) {
   // trim spaties
   while (*cmd==' ') ++cmd;
@@ -258,6 +365,17 @@ static void processSerialCmd(const char* cmd, uint32_t now) {
   if (!strcasecmp(cmd, "p") || !strcasecmp(cmd, "prev")) { doPrev(now); return; }
   if (!strcasecmp(cmd, "+") || !strcasecmp(cmd, "vol+") || !strcasecmp(cmd, "up")) { doVolUp(); return; }
   if (!strcasecmp(cmd, "-") || !strcasecmp(cmd, "vol-") || !strcasecmp(cmd, "down")) { doVolDown(); return; }
+  if (!strcasecmp(cmd, "stats")) { sendToRender(RenderCmd::StatsRequest, 0, now); return; } // print volgt in ioLoop()
+  if (!strcasecmp(cmd, "stats reset")) {
+    gIoProf.reset();
+    sv5w.resetCounters();
+    gIoWake.resetCounters();
+    gRenderCmdsDropped = 0;
+    sendToRender(RenderCmd::ResetStats, 0, now); // profiler, wake- en LED-tellers horen bij de render-taak
+    gStatsSinceMs = now;
+    Serial.println(F("CMD: stats reset"));
+    return;
+  }
   if (!strcasecmp(cmd, "h") || !strcasecmp(cmd, "help") || !strcasecmp(cmd, "?")) { printHelp(); return; }
 
   Serial.print(F("Unknown cmd: '")); Serial.print(cmd); Serial.println(F("' (type 'h')"));
@@ -278,106 +396,278 @@ static void pollSerial(uint32_t now) {
   }
 }
 
-void setup()
+// SV5W-hook: play-frame is echt verstuurd -> startpunt voor de cue-tijdlijn
+static void onSv5wSent(SV5W::Command cmd, uint32_t now, void*) {
+  if (cmd == SV5W::Command::SPECIFIED_SONG || cmd == SV5W::Command::SPECIFIED_PATH)
+    sendToRender(RenderCmd::PlaySent, 0, now);
+}
+
+// Callback voor SV5W-queries: ctx = label dat voor de databytes geprint wordt
+static void printSv5wResponse(const SV5W::Response& r, void* ctx) {
+  const char* label = (const char*)ctx;
+  if (r.valid) {
+    Serial.print(label);
+    for (auto b : r) { Serial.printf(" %02X", b); }
+    Serial.println();
+  } else {
+    Serial.print(label); Serial.println(F(" query failed."));
+  }
+}
+
+// ===================== Render-taak =====================
+static void sendTelemetry(uint32_t now) {
+  static RenderTelemetry t; // ~1 KB: niet op de stack van de render-taak
+  t = RenderTelemetry();
+  t.atMs = now;
+  t.mode = (uint8_t)gMode;
+  t.prof = gRenderProf;
+  for (int i = 0; i < Config::LED_COUNT; ++i) {
+    if (!LEDS[i]) continue;
+    t.dutyRequests += LEDS[i]->dutyRequests();
+    t.ledcWrites += LEDS[i]->writesIssued();
+  }
+  if (gFrame) t.frames = gFrame->frameCount();
+  for (const ModeSlot& slot : gSlots)
+    if (slot.thunder) t.bursts += slot.thunder->burstsStarted();
+  t.cuesFired = gCues.cuesFired();
+  t.cuesLate = gCues.cuesLate();
+  t.wakeups = gRenderWake.wakeups();
+  t.sleptMs = gRenderWake.sleptMs();
+  t.eventsDropped = gRenderEventsDropped;
+  if (gTelemetry.push(t)) Hal::wake(gIoTask);
+  else ++gRenderEventsDropped;
+}
+
+static void handleRenderCmd(const RenderCmd& c, uint32_t now) {
+  switch (c.kind) {
+    case RenderCmd::SetMode:  startMode((Mode)c.arg, now); break;
+    case RenderCmd::StepMode: stepMode(c.arg, now); break;
+    case RenderCmd::PlaySent: gCues.playSent(c.ms); break;
+    case RenderCmd::BusyEdge:
+      gRenderBusy = c.arg != 0;
+      gCues.busyEdge(gRenderBusy, c.ms);
+      break;
+    case RenderCmd::ResetStats:
+      gRenderProf.reset();
+      gRenderWake.resetCounters();
+      for (int i = 0; i < Config::LED_COUNT; ++i) if (LEDS[i]) LEDS[i]->resetCounters();
+      gRenderEventsDropped = 0;
+      break;
+    case RenderCmd::StatsRequest:
+      sendTelemetry(now);
+      break;
+  }
+}
+
+// Eén frame: opdrachten verwerken, programma's en overlays, mengen en committen; daarna slapen tot
+// de vroegste deadline (of tot de I/O-taak een opdracht stuurt), maar nooit vaker dan RENDER_FRAME_MS.
+static void renderFrame()
 {
-  Serial.begin(115200);
-  Serial.println(F("Thunderstorm Light Program starting..."));
-  pinMode(Config::PIN_BUSY, INPUT_PULLUP);
+  uint32_t now = millis();
+  gRenderProf.beginLoop();
+
+  RenderCmd cmd;
+  while (gToRender.pop(cmd)) handleRenderCmd(cmd, now);
+  gRenderProf.mark(LoopProfiler::Actions);
+
+  if (currentSlot && currentSlot->thunder)
+    gCues.update(now, gRenderBusy, *currentSlot->thunder);
+  if (currentProg)
+    currentProg->update(now);
+  // crossfade: het oude programma loopt door tot zijn laag helemaal weg is
+  if (outgoingSlot && gTransition && gTransition->active())
+    outgoingSlot->prog->update(now);
+  else
+    outgoingSlot = nullptr;
+  if (gTransition) gTransition->update(now);
+  if (gPixelStorm) gPixelStorm->update(now);
+  gRenderProf.mark(LoopProfiler::Program);
+
+  if (blinkSetPtr) {
+    gBlink.update(now, *blinkSetPtr);
+  }
+  gRenderProf.mark(LoopProfiler::Blink);
+
+  // Alle lagen mengen en één keer naar de hardware
+  if (gFrame) gFrame->commit(now);
+  if (gPixelFrame) gPixelFrame->commit(now); // start de RMT en wacht niet op de draad
+  gRenderProf.mark(LoopProfiler::Commit);
+  gRenderProf.endLoop();
+
+  gRenderWake.reset(now);
+  if (Config::LOOP_SLEEP) {
+    if (currentSlot && currentSlot->thunder) gRenderWake.request(gCues.nextWakeIn(now));
+    if (currentProg) gRenderWake.request(currentProg->nextWakeIn(now));
+    if (outgoingSlot) gRenderWake.request(outgoingSlot->prog->nextWakeIn(now));
+    if (gTransition) gRenderWake.request(gTransition->nextWakeIn(now));
+    gRenderWake.request(gBlink.nextWakeIn(now));
+    if (gFrame) gRenderWake.request(gFrame->nextWakeIn(now));
+    if (gPixelStorm) gRenderWake.request(gPixelStorm->nextWakeIn(now));
+    if (gPixelFrame) gRenderWake.request(gPixelFrame->nextWakeIn(now));
+  } else {
+    gRenderWake.request(0); // vaste framerate
+  }
+  gRenderWake.minInterval(Config::RENDER_FRAME_MS);
+  gRenderWake.sleep();
+}
+
+// Eén kanaal per pixel (tint uit Config), alle weights 1: de strip is één grote wolk
+static void setupPixelStrip()
+{
+  const int n = Config::WS2812_PIXELS;
+  if (!gPixelOut.begin(Config::WS2812_PIN, Config::WS2812_RMT_CH)) {
+    Serial.println(F("WS2812: RMT-kanaal niet beschikbaar"));
+    return;
+  }
+  gStrip = new Ws2812Strip(gPixelOut, n, Ws2812Strip::Layout::Mono);
+  gStrip->setTint(Config::WS2812_TINT[0], Config::WS2812_TINT[1], Config::WS2812_TINT[2]);
+  LedPwmChannel** px = new LedPwmChannel*[n];
+  float* weights = new float[n];
+  for (int i = 0; i < n; ++i) {
+    px[i] = new LedPwmChannel(*gStrip, i, 800000, Config::LEDC_RES_BITS);
+    px[i]->begin();
+    weights[i] = 1.0f;
+  }
+  gPixelFrame = new Compositor(px, n);
+  FrameLayer* layer = new FrameLayer(n, px[0]->maxDuty(), BlendMode::Replace);
+  gPixelFrame->addLayer(layer);
+  // pixels op een rechte lijn; na het opbouwen zijn alleen de afstandstabellen nog nodig
+  Config::LedPos* pos = new Config::LedPos[n];
+  for (int i = 0; i < n; ++i) pos[i] = { i * Config::WS2812_PITCH_CM, 0.0f, 0.0f };
+  StrikeField* field = new StrikeField(pos, n, weights);
+  delete[] pos;
+  gPixelStorm = new ProgThunder(*new LedSet(*layer, weights), weights, field);
+  gPixelStorm->seed(Rng::derive(gRngSeed, static_cast<uint32_t>(Mode::COUNT) + 1)); // na de SV5W-stroom
+  gPixelStorm->setCueSync(true); // geen eigen ritme: bursts komen van de thunder-modus (setFollower)
+  gPixelStorm->start(millis());
+  Serial.printf("WS2812: %d pixels op GPIO %d, %u us per frame\n", n, Config::WS2812_PIN,
+                (unsigned)(Ws2812::frameUs(gStrip->frameBytes()) + Ws2812::kResetUs));
+}
+
+static void renderTask(void*)
+{
+  for (;;) renderFrame();
+}
+
+// ===================== I/O-taak =====================
+static void ioSetup()
+{
+  gIoTask = Hal::currentTask(); // vóór de eerste opdracht: de render-taak wekt ons hiermee terug
+
+  // wake-bronnen wekken de taak die ze registreert: daarom hier en niet in setup()
   btnNext.begin();
   btnPrev.begin();
   btnVolUp.begin();
   btnVolDown.begin();
-  gLanterns.begin();
+  Hal::wakeOnPin(Config::PIN_BUSY); // BUSY-flank wekt de I/O-taak (knoppen: hun timer wekt per gebeurtenis)
+  Hal::wakeOnReceive(Serial);       // serial-commando's idem
 
-  printHelp();
-  gVolume = Config::VOLUME_DEFAULT;
-  sv5w.setVolume(gVolume);
-  
-  //sv5w BUSY pin initialiseren
+  //sv5w BUSY pin initialiseren; rammelt hij nog, dan zet de debounce in ioLoop() hem recht
   busyRaw   = sv5wBusyRaw();
-  delay(100);
   busyState = busyRaw;
-  delay(100);
+  busyLastEdgeMs = millis();
   Serial.printf("SV5W BUSY init: %s (active LOW)\n", busyState ? "ACTIVE (playing)" : "IDLE");
 
-  // LED kanalen initialiseren
-  for (int i = 0; i < Config::LED_COUNT; ++i) {
-    LEDS[i] = new LedPwmChannel(Config::LEDC_CH[i], Config::PIN_LED[i],
-                                Config::LEDC_FREQ, Config::LEDC_RES_BITS);
-    LEDS[i]->begin();
-    LEDS[i]->setDuty(0);
-  }
-
-  // LedSets per scenario (met weights uit Config)
-  thunderSetPtr = new LedSet(LEDS, Config::LED_COUNT, Config::LEDSET_THUNDER_WEIGHTS);
-  daySetPtr     = new LedSet(LEDS, Config::LED_COUNT, Config::LEDSET_DAY_WEIGHTS);
-  blinkSetPtr   = new LedSet(LEDS, Config::LED_COUNT, Config::LEDSET_BLINK_WEIGHTS); // <— nieuw
-
-  // Programma’s aanmaken op die sets
-  progThunderPtr = new ProgThunder(*thunderSetPtr, Config::LEDSET_THUNDER_WEIGHTS);
-  progDayPtr     = new ProgDay(*daySetPtr,       Config::LEDSET_DAY_WEIGHTS);
-  
-  //start knipper-overlay (optioneel)
-  gBlink.start(millis(), 500, 50, 1.0f, 0.0f); //test: start knipper-overlay (500ms periode, 50% duty)
-  //gBlink.start(millis(), 800, 50, 1.0f, 0.3f); //test: start knipper-overlay (800ms periode, 50% duty, 30% brightness)
-  //gBlink.stop(blinkSetPtr); //standaard uitzetten
-
-  // SV5W init
+  // SV5W init (alles gaat via de TX-queue; poll() verstuurt het zonder te blokkeren)
   sv5w.begin(Serial2, Config::UART_RX_PIN, Config::UART_TX_PIN, Config::UART_BAUD);
-  delay(100);
+  sv5w.gap(300); // settle na opstarten module: eerste frame pas na 300 ms, ioSetup() wacht er niet op
+  sv5w.onSent(onSv5wSent);
+  Hal::wakeOnReceive(Serial2); // antwoorden van de module wekken de I/O-taak
   sv5w.setVolume(gVolume);
   // Kies desgewenst standaard-drive (0x00=USB, 0x01=SD, 0x02=FLASH)
   sv5w.setDefaultDrive(0x01);
 
   // (Optioneel) huidige afspeeldrive uitlezen (test communicatie)
-  auto playdrive = sv5w.queryCurrentPlayDrive();
-  delay(100);
-  if (playdrive.valid) {
-    Serial.print(F("SV5W Current Play Drive: "));
-    for (auto b : playdrive.data) { Serial.printf(" %02X", b); }
-    Serial.println();
-  } else {
-    Serial.println(F("SV5W Current Play Drive query failed."));
-  }
+  sv5w.queryCurrentPlayDrive(printSv5wResponse, (void*)"SV5W Current Play Drive:");
 
   // (Optioneel) firmwareversie uitlezen
-  auto ver = sv5w.queryVersion();
-  delay(100);
-  if (ver.valid) {
-    Serial.print(F("SV5W Version bytes:"));
-    for (auto b : ver.data) { Serial.printf(" %02X", b); }
-    Serial.println();
-  } else {
-    Serial.println(F("SV5W Version query failed."));
-  }
+  sv5w.queryVersion(printSv5wResponse, (void*)"SV5W Version bytes:");
 
   uint32_t now = millis();
   
   if (btnNext.readRaw())  {
-    startMode(Mode::Day, now);
+    sendToRender(RenderCmd::SetMode, (int8_t)Mode::Day, now);
     Serial.println(F("Start in DAY mode (NEXT ingedrukt)."));
   }
   else
   {
-    startMode(Mode::Thunder, now);
+    sendToRender(RenderCmd::SetMode, (int8_t)Mode::Thunder, now);
     Serial.println(F("Start in THUNDER mode (standaard)."));
   }
     
   Serial.println(F("Klaar. NEXT/PREV voor moduswissel."));
 }
 
-void loop()
+// Vroegste deadline van de I/O-onderdelen verzamelen en tot dan slapen.
+// BUSY en UART hoeven niet gepold te worden: hun flank/event onderbreekt het slapen. Knoppen wekken
+// de taak pas met een gedebouncede gebeurtenis (timer-callback, zie Button.h).
+static void ioSleep(uint32_t now)
+{
+  gIoWake.reset(now);
+  if (Config::LOOP_SLEEP) {
+    if (busyRaw != busyState) gIoWake.request(WakeScheduler::until(now, busyLastEdgeMs + BUSY_DEBOUNCE_MS));
+    gIoWake.request(sv5w.nextPollIn(now));
+  } else {
+    gIoWake.request(0);
+  }
+  gIoWake.minInterval(1); // nooit de core vasthouden (idle-taak / task-watchdog)
+  gIoWake.sleep();
+}
+
+// Knopgebeurtenissen uit de queues; geen pin wordt hier gelezen
+static void handleButtons(uint32_t now)
+{
+  ButtonEvent ev;
+  while (btnNext.pop(ev)) {
+    if (ev.kind != ButtonEvent::Press) continue;
+    Serial.println(F("Modus wisselen: NEXT"));
+    sendToRender(RenderCmd::StepMode, +1, now);
+  }
+  while (btnPrev.pop(ev)) {
+    if (ev.kind != ButtonEvent::Press) continue;
+    Serial.println(F("Modus wisselen: PREV"));
+    sendToRender(RenderCmd::StepMode, -1, now);
+  }
+
+  //volume knoppen bediening: elke druk en elke auto-repeat is één stap
+  // (alleen absolute SET_VOLUME: de SV5W-queue voegt snelle herhalingen samen tot het laatste frame)
+  while (btnVolUp.pop(ev)) {
+    if (ev.kind != ButtonEvent::Press && ev.kind != ButtonEvent::Repeat) continue;
+    if(gVolume < Config::VOLUME_MAX) {
+      gVolume++;
+      sv5w.setVolume(gVolume);
+      Serial.print(F("Volume verhoogd naar ")); Serial.println(gVolume);
+    }
+  }
+  while (btnVolDown.pop(ev)) {
+    if (ev.kind != ButtonEvent::Press && ev.kind != ButtonEvent::Repeat) continue;
+    if(gVolume > Config::VOLUME_MIN) {
+      gVolume--;
+      sv5w.setVolume(gVolume);
+      Serial.print(F("Volume verlaagd naar ")); Serial.println(gVolume);
+    }
+  }
+  /*
+  //Voorbeeld om handmatig lantaarnpalen te schakelen via een knop (LongPress op NEXT)
+  if (ev.kind == ButtonEvent::LongPress) {
+  gLanterns.set(!gLanterns.isOn());  // handmatig overrule
+  }
+  */
+}
+
+static void ioLoop()
 {
-  static uint8_t volume = gVolume;
   uint32_t now = millis();
+  gIoProf.beginLoop();
   
-  //initialeseer knoppen:
-  btnNext.update(now);
-  btnPrev.update(now);
-  btnVolUp.update(now);
-  btnVolDown.update(now);
+  handleButtons(now);
+  gIoProf.mark(LoopProfiler::Buttons);
 
   pollSerial(now);
+  gIoProf.mark(LoopProfiler::SerialIn);
+
+  sv5w.poll(now); // TX-queue + RX-parser, blokkeert nooit
+  gIoProf.mark(LoopProfiler::Audio);
 
   // --- SV5W BUSY monitoring met debounce
   bool r = sv5wBusyRaw();
@@ -388,54 +678,114 @@ void loop()
 
   if (r != busyState && (now - busyLastEdgeMs) >= BUSY_DEBOUNCE_MS) {
     busyState = r;
+    sendToRender(RenderCmd::BusyEdge, busyState ? 1 : 0, busyLastEdgeMs);
     Serial.printf("[%lu ms] SV5W BUSY %s\n",
                   (unsigned long)now,
                   busyState ? "ACTIVE (playing)" : "IDLE");
   }
-
-  if (btnNext.consumePressed()) {
-    Serial.println(F("Modus wisselen: NEXT"));
-    nextMode(now);
-  }
-    
-  if (btnPrev.consumePressed()) {
-    Serial.println(F("Modus wisselen: PREV"));  
-    prevMode(now);
-  }
-  
-  //volume knoppen bediening
-  if (btnVolUp.consumePressed()){
-    if(volume < Config::VOLUME_MAX) {
-      volume++;
-      sv5w.setVolume(volume);
-      Serial.print(F("Volume verhoogd naar ")); Serial.println(volume);
-      sv5w.increaseVolume();
+  gIoProf.mark(LoopProfiler::Busy);
+
+  // terug van de render-taak: moduswissels (audio/lantaarns) en stats
+  RenderEvent ev;
+  while (gFromRender.pop(ev)) {
+    if (ev.kind == RenderEvent::ModeChanged) {
+      startModeAudio(ev.mode);
+      Serial.printf("Modus %u actief\n", (unsigned)ev.mode);
     }
   }
+  static RenderTelemetry telemetry; // ~1 KB: niet op de stack
+  while (gTelemetry.pop(telemetry)) printStats(telemetry);
+  gIoProf.mark(LoopProfiler::Actions);
+  gIoProf.endLoop();
 
-  if(btnVolDown.consumePressed()){
-    if(volume > Config::VOLUME_MIN) {
-      volume--;
-      sv5w.setVolume(volume);
-      Serial.print(F("Volume verlaagd naar ")); Serial.println(volume);
-      sv5w.decreaseVolume();
-    }
+  // slapen telt niet mee in 'loop', wel in 'period'
+  ioSleep(now);
+}
+
+static void ioTask(void*)
+{
+  ioSetup();
+  for (;;) ioLoop();
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println(F("Thunderstorm Light Program starting..."));
+  pinMode(Config::PIN_BUSY, INPUT_PULLUP);
+  gLanterns.begin();
+
+  printHelp();
+  gVolume = Config::VOLUME_DEFAULT;
+
+  // LED kanalen initialiseren: LEDC, of uitgangen van de PCA9685-borden
+  if (Config::LED_USE_PCA9685) {
+    gI2c.begin(Wire, Config::I2C_SDA_PIN, Config::I2C_SCL_PIN, Config::I2C_FREQ);
+    gPca = new Pca9685(gI2c, Config::PCA9685_ADDR, Config::PCA9685_BOARDS);
+    if (!gPca->begin(Config::PCA9685_PWM_FREQ))
+      Serial.printf("PCA9685: geen antwoord op 0x%02X..0x%02X\n", Config::PCA9685_ADDR,
+                    Config::PCA9685_ADDR + Config::PCA9685_BOARDS - 1);
   }
-  /*
-  //Voorbeeld om handmatig lantaarnpalen te schakelen via een knop
-  if (button3.consumePressed()) {
-  gLanterns.set(!gLanterns.isOn());  // handmatig overrule
+  for (int i = 0; i < Config::LED_COUNT; ++i) {
+    if (gPca)
+      LEDS[i] = new LedPwmChannel(*gPca, i, Config::PCA9685_PWM_FREQ, Config::LEDC_RES_BITS);
+    else
+      LEDS[i] = new LedPwmChannel(Config::LEDC_CH[i], Config::PIN_LED[i],
+                                  Config::LEDC_FREQ, Config::LEDC_RES_BITS);
+    LEDS[i]->begin();
+    LEDS[i]->setDuty(0);
+    LEDS[i]->commit();
   }
-  */
-  if (currentProg)
-    currentProg->update(now);
 
-  if (blinkSetPtr) {
-    gBlink.update(now, *blinkSetPtr);
+  // Eén master-seed; elk programma en de SV5W krijgen er een eigen stroom uit (Rng::derive)
+  gRngSeed = Config::RNG_SEED ? Config::RNG_SEED : (((uint64_t)Hal::random32() << 32) | Hal::random32());
+  Serial.printf("RNG seed: 0x%016llx (native: program --seed 0x%016llx)\n",
+                (unsigned long long)gRngSeed, (unsigned long long)gRngSeed);
+  sv5w.seedRandom(Rng::derive(gRngSeed, static_cast<uint32_t>(Mode::COUNT)));
+
+  // Lagen (onder -> boven): één per modus, knipper-overlay bovenop
+  uint16_t maxDuty = LEDS[0]->maxDuty();
+  gFrame = new Compositor(LEDS, Config::LED_COUNT);
+  gStrikeField = new StrikeField(Config::LED_POS, Config::LED_COUNT, Config::LEDSET_THUNDER_WEIGHTS);
+  for (int i = 0; i < static_cast<int>(Mode::COUNT); ++i) {
+    ModeSlot& slot = gSlots[i];
+    const ModeSpec& spec = MODE_TABLE[i];
+    slot.layer = new FrameLayer(Config::LED_COUNT, maxDuty, BlendMode::Replace);
+    slot.layer->setEnabled(false); // startMode()/Transition zetten de actieve laag aan
+    gFrame->addLayer(slot.layer);
+    // LedSet per modus (met weights uit Config) en het programma daarop
+    slot.set = new LedSet(*slot.layer, spec.weights);
+    if (spec.kind == ProgKind::Thunder) {
+      slot.thunder = new ProgThunder(*slot.set, spec.weights, gStrikeField);
+      slot.prog = slot.thunder;
+    } else {
+      slot.prog = new ProgDay(*slot.set, spec.weights);
+    }
+    slot.prog->seed(Rng::derive(gRngSeed, (uint32_t)i)); // stroom = modusindex
   }
-   
-  //
-  //LedSet* activeSet = (currentMode == Mode::Thunder) ? thunderSetPtr : daySetPtr;
-  //if (activeSet) gBlink.update(now, *activeSet);
+  blinkLayerPtr = new FrameLayer(Config::LED_COUNT, maxDuty, BlendMode::Replace);
+  gFrame->addLayer(blinkLayerPtr);
+  gTransition = new Transition(*gFrame);
+  blinkSetPtr = new BlinkSet(*blinkLayerPtr); // <— compile-time weights/masker
+  if (Config::WS2812_PIXELS > 0) setupPixelStrip();
+  
+  //start knipper-overlay (optioneel)
+  gBlink.start(millis(), 500, 50, 1.0f, 0.0f); //test: start knipper-overlay (500ms periode, 50% duty)
+  //gBlink.start(millis(), 800, 50, 1.0f, 0.3f); //test: start knipper-overlay (800ms periode, 50% duty, 30% brightness)
+  //gBlink.stop(blinkSetPtr); //standaard uitzetten
 
-}
\ No newline at end of file
+  // Taken starten: eerst render (de I/O-taak stuurt meteen een SetMode), dan I/O.
+  // Vanaf hier raakt setup() geen engine- of SV5W-state meer aan.
+  TaskHandle_t render = nullptr;
+  xTaskCreatePinnedToCore(renderTask, "render", Config::RENDER_TASK_STACK, nullptr,
+                          Config::RENDER_TASK_PRIO, &render, Config::RENDER_CORE);
+  gRenderTask = render;
+  xTaskCreatePinnedToCore(ioTask, "io", Config::IO_TASK_STACK, nullptr,
+                          Config::IO_TASK_PRIO, nullptr, Config::IO_CORE);
+}
+
+void loop()
+{
+  // alles draait in renderTask() en ioTask(); de Arduino loop-taak is niet meer nodig
+  vTaskDelete(nullptr);
+}
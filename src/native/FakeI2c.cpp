@@ -0,0 +1,73 @@
+// --- file: FakeI2c.cpp
+#include "FakeI2c.h"
+#include "Pca9685.h"
+
+namespace {
+    constexpr uint8_t kMode1Ai = 0x20;
+    constexpr uint8_t kFullBit = 0x10;
+}
+
+bool FakeI2cBus::addPca9685(uint8_t addr)
+{
+    if (devCount >= kMaxDevices || find(addr)) return false;
+    Device& d = devs[devCount++];
+    d.addr = addr;
+    for (uint8_t& r : d.regs) r = 0;
+    d.regs[Pca9685::kMode1] = 0x11;
+    d.regs[Pca9685::kMode2] = 0x04;
+    d.regs[Pca9685::kPreScale] = 0x1E; // 200 Hz
+    for (int i = 0; i < Pca9685::kChannelsPerChip; ++i) d.regs[Pca9685::kLed0OnL + 4 * i + 3] = kFullBit;
+    return true;
+}
+
+bool FakeI2cBus::write(uint8_t addr, const uint8_t* data, size_t n)
+{
+    ++txCount;
+    txBytes += n + 1;
+    lastUs = (uint32_t)(((uint64_t)(n + 1) * 9 + 2) * 1000000ull / busHz);
+    busUs += lastUs;
+    Device* d = find(addr);
+    if (failCount) --failCount, d = nullptr;
+    if (!d) { ++nackCount; return false; }
+    if (n == 0) return true;
+    uint8_t r = data[0];
+    bool ai = d->regs[Pca9685::kMode1] & kMode1Ai;
+    for (size_t i = 1; i < n; ++i) {
+        // PRE_SCALE alleen schrijfbaar in SLEEP (de chip negeert het anders)
+        if (r != Pca9685::kPreScale || (d->regs[Pca9685::kMode1] & 0x10)) d->regs[r] = data[i];
+        if (ai) ++r;
+    }
+    return true;
+}
+
+uint8_t FakeI2cBus::reg(uint8_t addr, uint8_t r) const
+{
+    const Device* d = find(addr);
+    return d ? d->regs[r] : 0;
+}
+
+uint16_t FakeI2cBus::pcaDuty(uint8_t addr, int out) const
+{
+    const Device* d = find(addr);
+    if (!d || out < 0 || out >= Pca9685::kChannelsPerChip) return 0;
+    const uint8_t* p = &d->regs[Pca9685::kLed0OnL + 4 * out];
+    if (p[3] & kFullBit) return 0;      // FULL_OFF wint van FULL_ON
+    if (p[1] & kFullBit) return 4095;
+    uint16_t on = (uint16_t)(p[0] | ((p[1] & 0x0F) << 8));
+    uint16_t off = (uint16_t)(p[2] | ((p[3] & 0x0F) << 8));
+    return (uint16_t)((off - on) & 0x0FFF);
+}
+
+FakeI2cBus::Device* FakeI2cBus::find(uint8_t addr)
+{
+    for (int i = 0; i < devCount; ++i)
+        if (devs[i].addr == addr) return &devs[i];
+    return nullptr;
+}
+
+const FakeI2cBus::Device* FakeI2cBus::find(uint8_t addr) const
+{
+    for (int i = 0; i < devCount; ++i)
+        if (devs[i].addr == addr) return &devs[i];
+    return nullptr;
+}
@@ -0,0 +1,47 @@
+// --- file: FakeI2c.h
+#pragma once
+#include "Hal.h"
+
+// Host-side I2C-bus voor de native build, met geëmuleerde PCA9685-borden.
+// - Elke write() is één transactie; onbekend adres = NACK.
+// - PCA9685: registerbestand van 256 bytes met auto-increment (MODE1.AI), zoals de chip.
+// - Bustijd per transactie: (adres + n bytes) x 9 klokken + START/STOP, bij de ingestelde klok.
+// - Storing: failNext(n) laat de volgende n transacties mislukken (NACK, geen register geschreven).
+class FakeI2cBus : public Hal::I2cBus {
+public:
+    static constexpr int kMaxDevices = 8;
+
+    explicit FakeI2cBus(uint32_t hz = 400000) : busHz(hz) {}
+
+    bool write(uint8_t addr, const uint8_t* data, size_t n) override;
+
+    // PCA9685 op addr (na power-on: MODE1 = 0x11, SLEEP + ALLCALL; alle uitgangen FULL_OFF)
+    bool addPca9685(uint8_t addr);
+    uint8_t reg(uint8_t addr, uint8_t r) const;
+    // huidige duty (0..4095) van uitgang out, terugvertaald uit de ON/OFF-registers
+    uint16_t pcaDuty(uint8_t addr, int out) const;
+    // de volgende n transacties krijgen een NACK, ongeacht het adres (bv. storing op de bus)
+    void failNext(uint32_t n) { failCount = n; }
+
+    // --- tellers
+    uint32_t transactions() const { return txCount; }
+    uint64_t bytes() const { return txBytes; }          // incl. adresbyte
+    uint32_t nacks() const { return nackCount; }
+    uint64_t busTimeUs() const { return busUs; }        // som van alle transacties
+    uint32_t lastTransactionUs() const { return lastUs; }
+    void resetCounters() { txCount = 0; txBytes = 0; nackCount = 0; busUs = 0; lastUs = 0; }
+
+private:
+    struct Device {
+        uint8_t addr = 0;
+        uint8_t regs[256] = {};
+    };
+    uint32_t busHz;
+    Device devs[kMaxDevices];
+    int devCount = 0;
+    uint32_t txCount = 0, nackCount = 0, lastUs = 0, failCount = 0;
+    uint64_t txBytes = 0, busUs = 0;
+
+    Device* find(uint8_t addr);
+    const Device* find(uint8_t addr) const;
+};
@@ -0,0 +1,263 @@
+// --- file: GoldenTrace.cpp
+#include "GoldenTrace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Hal.h"
+#include "Config.h"
+#include "DutyTrace.h"
+#include "Compositor.h"
+#include "LedSet.h"
+#include "StaticLedSet.h"
+#include "LightProgram.h"
+#include "BlinkOverlay.h"
+#include "Transition.h"
+#include "Rng.h"
+
+namespace {
+
+using Buffer = std::vector<uint8_t>;
+using BlinkSet = StaticLedSet<Config::LED_COUNT, Config::LEDSET_BLINK_WEIGHTS>;
+
+struct Scenario {
+    const char* name;
+    uint64_t seed;
+    uint32_t minutes;
+    void (*run)(LedPwmChannel** leds, uint64_t seed, uint32_t minutes);
+};
+
+// Zelfde stromen als main.cpp (modusindex): Thunder = 0, Day = 1
+constexpr uint32_t kThunderStream = 0;
+constexpr uint32_t kDayStream = 1;
+
+// Afstandstabellen van Config::LED_POS, zoals gStrikeField in main.cpp
+const StrikeField& ledField() {
+    static StrikeField field(Config::LED_POS, Config::LED_COUNT, Config::LEDSET_THUNDER_WEIGHTS);
+    return field;
+}
+
+void freshEngine(LedPwmChannel** leds) {
+    Hal::sim::reset();
+    for (int i = 0; i < Config::LED_COUNT; ++i) { leds[i]->begin(); leds[i]->resetCounters(); }
+}
+
+// Onweer alleen, 1 kHz zoals de render-taak met een vaste framerate
+void runThunder(LedPwmChannel** leds, uint64_t seed, uint32_t minutes) {
+    Compositor frame(leds, Config::LED_COUNT);
+    FrameLayer layer(Config::LED_COUNT, leds[0]->maxDuty());
+    frame.addLayer(&layer);
+    LedSet set(layer, Config::LEDSET_THUNDER_WEIGHTS);
+    ProgThunder thunder(set, Config::LEDSET_THUNDER_WEIGHTS, &ledField());
+    thunder.seed(Rng::derive(seed, kThunderStream));
+    thunder.start(Hal::millis());
+    for (uint32_t ms = 0; ms < minutes * 60000u; ++ms) {
+        uint32_t now = Hal::millis();
+        thunder.update(now);
+        frame.commit(now);
+        Hal::sim::advance(1);
+    }
+}
+
+// Dag-golf met sparkles
+void runDay(LedPwmChannel** leds, uint64_t seed, uint32_t minutes) {
+    Compositor frame(leds, Config::LED_COUNT);
+    FrameLayer layer(Config::LED_COUNT, leds[0]->maxDuty());
+    frame.addLayer(&layer);
+    LedSet set(layer, Config::LEDSET_DAY_WEIGHTS);
+    ProgDay day(set, Config::LEDSET_DAY_WEIGHTS);
+    day.seed(Rng::derive(seed, kDayStream));
+    day.start(Hal::millis());
+    for (uint32_t ms = 0; ms < minutes * 60000u; ++ms) {
+        uint32_t now = Hal::millis();
+        day.update(now);
+        frame.commit(now);
+        Hal::sim::advance(1);
+    }
+}
+
+// Knipper-overlay met wisselende periode/duty/niveaus (geen RNG, maar wel de StaticLedSet-paden)
+void runBlink(LedPwmChannel** leds, uint64_t seed, uint32_t minutes) {
+    (void)seed;
+    Compositor frame(leds, Config::LED_COUNT);
+    FrameLayer layer(Config::LED_COUNT, leds[0]->maxDuty());
+    frame.addLayer(&layer);
+    BlinkSet set(layer);
+    BlinkOverlay blink;
+    static const struct { uint32_t period; uint8_t duty; float on, off; } kSteps[] = {
+        { 500, 50, 1.0f, 0.0f }, { 800, 30, 0.6f, 0.1f }, { 120, 75, 1.0f, 0.3f }, { 2000, 10, 0.4f, 0.0f },
+    };
+    for (uint32_t ms = 0; ms < minutes * 60000u; ++ms) {
+        uint32_t now = Hal::millis();
+        if (ms % 60000u == 0) {
+            const auto& s = kSteps[(ms / 60000u) % 4];
+            blink.start(now, s.period, s.duty, s.on, s.off);
+        }
+        blink.update(now, set);
+        frame.commit(now);
+        Hal::sim::advance(1);
+    }
+}
+
+// Zoals main.cpp: dag -> onweer met crossfade, knipper-overlay erboven, elke 3 min wisselen
+void runMix(LedPwmChannel** leds, uint64_t seed, uint32_t minutes) {
+    uint16_t maxDuty = leds[0]->maxDuty();
+    Compositor frame(leds, Config::LED_COUNT);
+    FrameLayer dayLayer(Config::LED_COUNT, maxDuty), thunderLayer(Config::LED_COUNT, maxDuty);
+    FrameLayer blinkLayer(Config::LED_COUNT, maxDuty);
+    frame.addLayer(&dayLayer);
+    frame.addLayer(&thunderLayer);
+    frame.addLayer(&blinkLayer);
+    LedSet daySet(dayLayer, Config::LEDSET_DAY_WEIGHTS);
+    LedSet thunderSet(thunderLayer, Config::LEDSET_THUNDER_WEIGHTS);
+    BlinkSet blinkSet(blinkLayer);
+    ProgDay day(daySet, Config::LEDSET_DAY_WEIGHTS);
+    ProgThunder thunder(thunderSet, Config::LEDSET_THUNDER_WEIGHTS, &ledField());
+    day.seed(Rng::derive(seed, kDayStream));
+    thunder.seed(Rng::derive(seed, kThunderStream));
+    Transition transition(frame);
+    BlinkOverlay blink;
+
+    uint32_t now = Hal::millis();
+    thunderLayer.setEnabled(false);
+    day.start(now);
+    blink.start(now, 1000, 20, 0.5f, 0.0f);
+    bool dayActive = true;
+    for (uint32_t ms = 0; ms < minutes * 60000u; ++ms) {
+        now = Hal::millis();
+        if (ms > 0 && ms % 180000u == 0) {
+            LightProgram* next = dayActive ? (LightProgram*)&thunder : (LightProgram*)&day;
+            next->start(now);
+            transition.begin(dayActive ? &dayLayer : &thunderLayer, dayActive ? &thunderLayer : &dayLayer,
+                             now, Config::MODE_CROSSFADE_MS);
+            dayActive = !dayActive;
+        }
+        transition.update(now);
+        if (dayActive || transition.active()) day.update(now);
+        if (!dayActive || transition.active()) thunder.update(now);
+        blink.update(now, blinkSet);
+        frame.commit(now);
+        Hal::sim::advance(1);
+    }
+}
+
+const Scenario kScenarios[] = {
+    { "thunder", 0x5EED0001ull, 20, runThunder },
+    { "day",     0x5EED0002ull, 4,  runDay },
+    { "blink",   0x5EED0003ull, 8,  runBlink },
+    { "mix",     0x5EED0004ull, 10, runMix },
+};
+
+void appendToBuffer(const uint8_t* data, size_t n, void* ctx) {
+    Buffer* b = (Buffer*)ctx;
+    b->insert(b->end(), data, data + n);
+}
+
+Buffer record(const Scenario& s, LedPwmChannel** leds, uint32_t& events, uint32_t& dropped) {
+    Buffer out;
+    freshEngine(leds);
+    DutyTraceWriter writer(appendToBuffer, &out);
+    writer.begin(s.seed, Hal::millis());
+    LedPwmChannel::setTrace(&writer);
+    s.run(leds, s.seed, s.minutes);
+    LedPwmChannel::setTrace(nullptr);
+    writer.flush();
+    events = writer.events();
+    dropped = writer.dropped();
+    return out;
+}
+
+bool readFile(const std::string& path, Buffer& out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) out.insert(out.end(), chunk, chunk + n);
+    fclose(f);
+    return true;
+}
+
+bool writeFile(const std::string& path, const Buffer& data) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+void printEvent(const char* label, const DutyTrace::Event& e) {
+    printf("    %-8s %10u ms  ch %3u  duty %4u\n", label, e.ms, e.ch, e.duty);
+}
+
+// Gebeurtenis voor gebeurtenis vergelijken; de eerste afwijking met wat context tonen
+bool diff(const Buffer& golden, const Buffer& actual) {
+    DutyTraceReader g(golden.data(), golden.size()), a(actual.data(), actual.size());
+    if (!g.valid()) { printf("    golden spoor onleesbaar\n"); return false; }
+    if (g.seed() != a.seed()) printf("    seed verschilt: golden 0x%llx, nu 0x%llx\n",
+                                     (unsigned long long)g.seed(), (unsigned long long)a.seed());
+    DutyTrace::Event ge{}, ae{}, lastSame{};
+    uint64_t index = 0, mismatches = 0;
+    bool any = false;
+    for (;;) {
+        bool hg = g.next(ge), ha = a.next(ae);
+        if (!hg && !ha) break;
+        if (hg && ha && ge == ae) { lastSame = ge; any = true; ++index; continue; }
+        if (++mismatches == 1) {
+            printf("    eerste afwijking bij gebeurtenis %llu:\n", (unsigned long long)index);
+            if (any) printEvent("laatste=", lastSame);
+            if (hg) printEvent("golden", ge); else printf("    golden   (einde)\n");
+            if (ha) printEvent("nu", ae); else printf("    nu       (einde)\n");
+        }
+        if (!hg || !ha) break; // lengte verschilt: verder tellen heeft geen zin
+        ++index;
+    }
+    if (!g.valid()) printf("    golden spoor beschadigd na %llu gebeurtenissen\n", (unsigned long long)index);
+    if (mismatches) printf("    %llu afwijkende gebeurtenis(sen)\n", (unsigned long long)mismatches);
+    return mismatches == 0 && g.valid() && a.valid();
+}
+
+} // namespace
+
+namespace Golden {
+
+int run(const char* mode, const char* dir, LedPwmChannel** leds) {
+    bool recordMode = !strcmp(mode, "record");
+    if (!recordMode && strcmp(mode, "check")) {
+        printf("Onbekende golden-modus: %s (check|record)\n", mode);
+        return 2;
+    }
+    bool ok = true;
+    for (const Scenario& s : kScenarios) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint32_t events = 0, dropped = 0;
+        Buffer actual = record(s, leds, events, dropped);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::string path = std::string(dir) + "/" + s.name + ".ltr";
+        printf("%-8s: %3u min @1 kHz, %8u gebeurtenissen, %7zu bytes (%.2f B/gebeurtenis, %.0f KB/uur), %.2f s\n",
+               s.name, s.minutes, events, actual.size(), events ? (double)actual.size() / events : 0.0,
+               actual.size() * 60.0 / s.minutes / 1024.0, secs);
+        if (dropped) {
+            // kanaal buiten het formaat: het spoor mist uitvoer, dus nooit opslaan of goedkeuren
+            printf("    %u gebeurtenis(sen) niet in het spoor (spoorkanaal buiten 0..%d)\n", dropped, DutyTrace::kMaxChannels - 1);
+            ok = false;
+            continue;
+        }
+        if (recordMode) {
+            if (!writeFile(path, actual)) { printf("    kan %s niet schrijven\n", path.c_str()); ok = false; }
+            continue;
+        }
+        Buffer golden;
+        if (!readFile(path, golden)) {
+            printf("    %s ontbreekt (eerst --golden record)\n", path.c_str());
+            ok = false;
+            continue;
+        }
+        bool same = diff(golden, actual);
+        printf("    %s\n", same ? "identiek aan golden" : "** AFWIJKING **");
+        ok &= same;
+    }
+    printf("golden %-6s: %s\n", mode, ok ? "ok" : "** MISLUKT **");
+    return ok ? 0 : 1;
+}
+
+} // namespace Golden
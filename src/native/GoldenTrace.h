@@ -0,0 +1,14 @@
+// --- file: GoldenTrace.h
+#pragma once
+#include "LedPwm.h"
+
+// Golden traces: vaste, geseede scenario's (ProgThunder, ProgDay, BlinkOverlay, crossfade) op de
+// virtuele klok, opgenomen bij LedPwmChannel (DutyTrace.h) en vergeleken met opgeslagen sporen.
+// Een wijziging aan het hete pad (setWithSkew, Compositor, ...) moet bit-identieke uitvoer geven.
+//   program --golden check                 # alle scenario's tegen src/native/golden/*.ltr
+//   program --golden record                # sporen (her)schrijven na een bedoelde gedragswijziging
+//   program --golden check --golden-dir DIR
+namespace Golden {
+    // mode: "check" of "record"; 0 = alles gelijk/geschreven
+    int run(const char* mode, const char* dir, LedPwmChannel** leds);
+}
@@ -0,0 +1,209 @@
+// --- file: HalNative.cpp
+// Gesimuleerde HAL voor de native build: virtuele klok, pinnen (incl. geplande wissels, wake-pinnen en
+// pin-ISR's), one-shot timers, PWM-registers en RNG.
+#include "Hal.h"
+
+namespace {
+    uint64_t gMicros = 0;
+    int gPin[Hal::sim::kMaxPins];
+    uint32_t gDuty[Hal::sim::kMaxPwm];
+    uint32_t gWrites[Hal::sim::kMaxPwm];
+
+    // Geplande pinwissels (knoppen, BUSY), op tijd gesorteerd
+    struct PinEvent { uint64_t atUs; int pin; int level; };
+    constexpr int kMaxPinEvents = 64;
+    PinEvent gPinEvents[kMaxPinEvents];
+    int gPinEventCount = 0;
+    bool gWakePin[Hal::sim::kMaxPins];
+    bool gWakePending = false;
+
+    struct PinIsr { void (*fn)(void*); void* arg; };
+    PinIsr gPinIsr[Hal::sim::kMaxPins];
+
+    // One-shot timers; TimerRef wijst naar een slot
+    struct Timer { void (*fn)(void*); void* arg; uint64_t dueUs; bool armed; };
+    Timer gTimers[Hal::sim::kMaxTimers];
+    int gTimerCount = 0;
+    uint32_t gTimerFires = 0;
+
+    Timer* nextTimer() {
+        Timer* best = nullptr;
+        for (int i = 0; i < gTimerCount; ++i)
+            if (gTimers[i].armed && (!best || gTimers[i].dueUs < best->dueUs)) best = &gTimers[i];
+        return best;
+    }
+
+    void setLevel(int pin, int level) {
+        bool changed = gPin[pin] != level;
+        gPin[pin] = level;
+        if (changed && gPinIsr[pin].fn) gPinIsr[pin].fn(gPinIsr[pin].arg);
+    }
+
+    // Pinwissels en timers t/m uptoUs in tijdsvolgorde afhandelen; de klok staat tijdens een ISR of
+    // callback op het tijdstip ervan. stopAtWake: stoppen zodra een wake-pin verandert of een callback
+    // wake() aanroept (true; tijd staat dan op dat moment).
+    bool runUntil(uint64_t uptoUs, bool stopAtWake) {
+        for (;;) {
+            Timer* t = nextTimer();
+            bool pinFirst = gPinEventCount > 0 && (!t || gPinEvents[0].atUs <= t->dueUs);
+            uint64_t at = pinFirst ? gPinEvents[0].atUs : t ? t->dueUs : UINT64_MAX;
+            if (at > uptoUs) return false;
+            if (at > gMicros) gMicros = at;
+            if (pinFirst) {
+                PinEvent e = gPinEvents[0];
+                for (int k = 1; k < gPinEventCount; ++k) gPinEvents[k - 1] = gPinEvents[k];
+                --gPinEventCount;
+                bool changed = gPin[e.pin] != e.level;
+                setLevel(e.pin, e.level);
+                if (changed && gWakePin[e.pin] && stopAtWake) return true;
+            } else {
+                t->armed = false;
+                ++gTimerFires;
+                t->fn(t->arg);
+            }
+            if (gWakePending && stopAtWake) return true;
+        }
+    }
+
+    void advanceTo(uint64_t us) {
+        runUntil(us, false);
+        gMicros = us;
+    }
+
+    uint64_t gRng = 0x9E3779B97F4A7C15ull;
+    bool gLog = true;
+    bool gInit = false;
+
+    void ensureInit() {
+        if (gInit) return;
+        gInit = true;
+        Hal::sim::reset();
+    }
+}
+
+namespace Hal {
+
+uint32_t millis() { return (uint32_t)(gMicros / 1000u); }
+uint32_t micros() { return (uint32_t)gMicros; }
+void delay(uint32_t ms) { advanceTo(gMicros + (uint64_t)ms * 1000u); }
+
+uint32_t random32() {
+    // xorshift64*: snel en reproduceerbaar via sim::seedRandom()
+    gRng ^= gRng >> 12;
+    gRng ^= gRng << 25;
+    gRng ^= gRng >> 27;
+    return (uint32_t)((gRng * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+void pinMode(int pin, uint8_t mode) {
+    ensureInit();
+    if (pin < 0 || pin >= sim::kMaxPins) return;
+    if (mode == INPUT_PULLUP) gPin[pin] = HIGH;
+}
+
+int digitalRead(int pin) {
+    ensureInit();
+    return (pin >= 0 && pin < sim::kMaxPins) ? gPin[pin] : LOW;
+}
+
+void digitalWrite(int pin, uint8_t level) {
+    ensureInit();
+    if (pin >= 0 && pin < sim::kMaxPins) gPin[pin] = level ? HIGH : LOW;
+}
+
+void pwmSetup(int ch, uint32_t freq, uint8_t resBits) { (void)ch; (void)freq; (void)resBits; }
+void pwmAttach(int pin, int ch) { (void)pin; (void)ch; }
+
+void pwmWrite(int ch, uint32_t duty) {
+    if (ch < 0 || ch >= sim::kMaxPwm) return;
+    gDuty[ch] = duty;
+    ++gWrites[ch];
+}
+
+void waitUntil(uint32_t deadlineMs) {
+    if (gWakePending) { gWakePending = false; return; }
+    int32_t ms = (int32_t)(deadlineMs - millis());
+    if (ms <= 0) return;
+    uint64_t target = (gMicros / 1000u + (uint64_t)ms) * 1000u; // begin van de deadline-milliseconde
+    if (!runUntil(target, true)) gMicros = target;
+    gWakePending = false; // een wake uit een callback tijdens het slapen is hiermee verbruikt
+}
+
+void wake(TaskRef task) { (void)task; gWakePending = true; }
+
+void wakeOnPin(int pin) {
+    ensureInit();
+    if (pin >= 0 && pin < sim::kMaxPins) gWakePin[pin] = true;
+}
+
+void attachPinIsr(int pin, void (*isr)(void*), void* arg) {
+    ensureInit();
+    if (pin >= 0 && pin < sim::kMaxPins) gPinIsr[pin] = { isr, arg };
+}
+
+TimerRef timerCreate(const char* name, void (*fn)(void*), void* arg) {
+    (void)name;
+    ensureInit();
+    if (gTimerCount >= sim::kMaxTimers) return nullptr;
+    gTimers[gTimerCount] = { fn, arg, 0, false };
+    return &gTimers[gTimerCount++];
+}
+
+void timerArm(TimerRef t, uint32_t ms) {
+    if (!t) return;
+    Timer* tm = (Timer*)t;
+    tm->dueUs = gMicros + (uint64_t)(ms ? ms : 1) * 1000u; // zoals op de ESP32: minstens één tick
+    tm->armed = true;
+}
+
+void timerArmFromIsr(TimerRef t, uint32_t ms) { timerArm(t, ms); }
+
+void log(const char* msg) {
+    if (gLog) std::puts(msg);
+}
+
+namespace sim {
+
+void reset() {
+    gInit = true;
+    gMicros = 0;
+    for (int i = 0; i < kMaxPins; ++i) gPin[i] = HIGH;
+    for (int i = 0; i < kMaxPins; ++i) gWakePin[i] = false;
+    for (int i = 0; i < kMaxPwm; ++i) { gDuty[i] = 0; gWrites[i] = 0; }
+    for (int i = 0; i < kMaxPins; ++i) gPinIsr[i] = PinIsr();
+    gPinEventCount = 0;
+    gWakePending = false;
+    gTimerCount = 0;
+    gTimerFires = 0;
+}
+
+void setMillis(uint32_t ms) { gMicros = (uint64_t)ms * 1000u; }
+void advance(uint32_t ms) { advanceTo(gMicros + (uint64_t)ms * 1000u); }
+void advanceMicros(uint32_t us) { advanceTo(gMicros + us); }
+uint64_t micros64() { return gMicros; }
+
+void setPin(int pin, int level) {
+    ensureInit();
+    if (pin >= 0 && pin < kMaxPins) setLevel(pin, level ? HIGH : LOW);
+}
+
+bool schedulePin(int pin, int level, uint64_t atUs) {
+    ensureInit();
+    if (pin < 0 || pin >= kMaxPins || gPinEventCount >= kMaxPinEvents) return false;
+    int k = gPinEventCount++;
+    while (k > 0 && gPinEvents[k - 1].atUs > atUs) { gPinEvents[k] = gPinEvents[k - 1]; --k; }
+    gPinEvents[k] = { atUs, pin, level ? HIGH : LOW };
+    return true;
+}
+
+int pinLevel(int pin) { return digitalRead(pin); }
+
+uint32_t pwmDuty(int ch) { return (ch >= 0 && ch < kMaxPwm) ? gDuty[ch] : 0; }
+uint32_t pwmWrites(int ch) { return (ch >= 0 && ch < kMaxPwm) ? gWrites[ch] : 0; }
+uint32_t timerFires() { return gTimerFires; }
+
+void seedRandom(uint64_t seed) { gRng = seed ? seed : 0x9E3779B97F4A7C15ull; }
+void setLogEnabled(bool enable) { gLog = enable; }
+
+} // namespace sim
+} // namespace Hal
@@ -0,0 +1,74 @@
+// --- file: RmtSink.cpp
+#include "RmtSink.h"
+#include "Ws2812.h"
+
+namespace {
+    // WS2812B-datasheet: T0H 0.40 us, T1H 0.80 us, T0L 0.85 us, T1L 0.45 us, elk +-150 ns
+    constexpr uint32_t kT0HNs = 400, kT1HNs = 800, kT0LNs = 850, kT1LNs = 450, kTolNs = 150;
+
+    bool within(uint32_t ns, uint32_t spec) { return ns + kTolNs >= spec && ns <= spec + kTolNs; }
+}
+
+void RmtSink::checkInFlight()
+{
+    if (!inFlight || tornThisFrame) return;
+    if (memcmp(inFlight, snapshot.data(), snapshot.size()) != 0) {
+        tornThisFrame = true;
+        ++torn;
+    }
+}
+
+bool RmtSink::busy()
+{
+    uint64_t now = Hal::sim::micros64();
+    if (inFlight) {
+        checkInFlight();
+        if (now >= endUs) inFlight = nullptr; // laatste bit is weg; de buffer is weer vrij
+    }
+    return now < latchUs;
+}
+
+bool RmtSink::send(const uint8_t* data, size_t n)
+{
+    if (busy()) { ++overrun; return false; }
+
+    // coderen in stukken van een half RMT-geheugen, zoals de driver het in zijn ISR bijvult
+    items.assign(n * 8, 0);
+    size_t done = 0, k = 0;
+    while (done < n) {
+        size_t used = 0, got = 0;
+        Ws2812::encode(data + done, n - done, items.data() + k, memItems / 2, &used, &got);
+        ++refillCount;
+        if (used == 0) break;
+        done += used;
+        k += got;
+    }
+
+    // pulsen meten en terug naar bytes
+    decoded.assign(n, 0);
+    for (size_t i = 0; i < k; ++i) {
+        uint32_t it = items[i];
+        uint32_t highNs = (it & 0x7FFF) * Ws2812::kTickNs;
+        uint32_t lowNs = ((it >> 16) & 0x7FFF) * Ws2812::kTickNs;
+        bool levelsOk = (it >> 15) & 1 && !((it >> 31) & 1);
+        bool one = highNs >= (kT0HNs + kT1HNs) / 2;
+        bool timingOk = one ? within(highNs, kT1HNs) && within(lowNs, kT1LNs)
+                            : within(highNs, kT0HNs) && within(lowNs, kT0LNs);
+        if (!levelsOk || !timingOk) ++badTiming;
+        if (one) decoded[i / 8] |= (uint8_t)(0x80 >> (i % 8));
+    }
+    for (size_t i = 0; i < n; ++i)
+        if (i >= k / 8 || decoded[i] != data[i]) ++badDecode;
+
+    snapshot.assign(data, data + n);
+    inFlight = data;
+    tornThisFrame = false;
+    uint64_t now = Hal::sim::micros64();
+    uint32_t us = Ws2812::frameUs(n);
+    endUs = now + us;
+    latchUs = endUs + Ws2812::kResetUs;
+    wireTotalUs += us;
+    ++frameCount;
+    byteCount += n;
+    return true;
+}
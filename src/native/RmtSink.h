@@ -0,0 +1,46 @@
+// --- file: RmtSink.h
+#pragma once
+#include <vector>
+#include "Hal.h"
+
+// Host-side RMT + WS2812-strip voor de native build (Hal::PixelOut).
+// - send() codeert het frame zoals de ESP32-driver: Ws2812::encode() per half RMT-geheugen (refill).
+// - Elk item wordt gemeten tegen de WS2812B-datasheet (T0H/T1H/T0L/T1L, +-150 ns) en terug naar
+//   bytes gedecodeerd; dat moet exact de verzonden buffer zijn.
+// - Draadtijd op de virtuele klok: busy() tot het laatste bit + reset-pauze voorbij is.
+// - Verandert de buffer terwijl hij nog op de draad staat (enkelvoudige buffer), dan telt dat als torn frame.
+class RmtSink : public Hal::PixelOut {
+public:
+    explicit RmtSink(size_t memItems = 128) : memItems(memItems) {}
+
+    bool busy() override;
+    bool send(const uint8_t* data, size_t n) override;
+
+    // wat de pixels van het laatste frame ontvingen (GRB, gedecodeerd uit de pulsen)
+    const std::vector<uint8_t>& lastFrame() const { return decoded; }
+    // tijdstip (us) waarop het huidige/laatste frame klaar is inclusief reset
+    uint64_t latchAtUs() const { return latchUs; }
+
+    // --- tellers
+    uint32_t frames() const { return frameCount; }
+    uint64_t bytes() const { return byteCount; }
+    uint32_t refills() const { return refillCount; }       // translator-aanroepen (ISR op de ESP32)
+    uint32_t timingErrors() const { return badTiming; }     // items buiten de datasheet
+    uint32_t decodeErrors() const { return badDecode; }     // gedecodeerd byte != verzonden byte
+    uint32_t tornFrames() const { return torn; }            // buffer gewijzigd tijdens het zenden
+    uint32_t overruns() const { return overrun; }           // send() terwijl de draad nog bezig was
+    uint64_t wireUs() const { return wireTotalUs; }
+
+private:
+    size_t memItems;
+    std::vector<uint32_t> items;
+    std::vector<uint8_t> decoded;
+    std::vector<uint8_t> snapshot;   // inhoud bij send(), om tearing te zien
+    const uint8_t* inFlight = nullptr;
+    uint64_t endUs = 0, latchUs = 0;
+    uint32_t frameCount = 0, refillCount = 0, badTiming = 0, badDecode = 0, torn = 0, overrun = 0;
+    uint64_t byteCount = 0, wireTotalUs = 0;
+    bool tornThisFrame = false;
+
+    void checkInFlight();
+};
@@ -0,0 +1,198 @@
+// --- file: SV5WMock.cpp
+#include "SV5WMock.h"
+
+SV5WMock::SV5WMock(uint32_t baud, int busy)
+    : byteUs(baud ? (10u * 1000000u + baud - 1) / baud : 1042u), busyPin(busy)
+{
+    if (busyPin >= 0) Hal::sim::setPin(busyPin, HIGH); // idle
+}
+
+int SV5WMock::available()
+{
+    uint64_t now = Hal::sim::micros64();
+    int n = 0;
+    while (n < (int)outCount && out[(outHead + n) % kOutMax].atUs <= now) ++n;
+    return n;
+}
+
+int SV5WMock::read()
+{
+    if (outCount == 0 || out[outHead].atUs > Hal::sim::micros64()) return -1;
+    uint8_t b = out[outHead].b;
+    outHead = (outHead + 1) % kOutMax;
+    --outCount;
+    return b;
+}
+
+size_t SV5WMock::write(uint8_t b)
+{
+    // byte komt pas binnen als het volledig over de lijn is
+    uint64_t now = Hal::sim::micros64();
+    if (lineFreeUs < now) lineFreeUs = now;
+    lineFreeUs += byteUs;
+    ++rxBytes;
+
+    switch (stage) {
+        case 0:
+            if (b == 0xAA) { sum = b; stage = 1; }
+            break;
+        case 1:
+            cmd = b; sum += b; stage = 2;
+            break;
+        case 2:
+            len = b; sum += b; pos = 0; stage = (len == 0) ? 4 : 3;
+            break;
+        case 3:
+            data[pos++] = b; sum += b;
+            if (pos == len) stage = 4;
+            break;
+        case 4:
+            stage = 0;
+            if (b == sum) frameComplete(lineFreeUs);
+            else ++rxBad;
+            break;
+    }
+    return 1;
+}
+
+void SV5WMock::update()
+{
+    uint64_t now = Hal::sim::micros64();
+    if (status == Playing && trackLenMs > 0 && now >= playStartUs &&
+        playedUs + (now - playStartUs) >= (uint64_t)trackLenMs * 1000u) {
+        if (loopMode == 1) startTrack(now, track); // single loop
+        else status = Stopped;
+    }
+    if (busyPin >= 0) {
+        bool busy = status == Playing && now >= playStartUs + (uint64_t)busyDelayMs * 1000u;
+        Hal::sim::setPin(busyPin, busy ? LOW : HIGH);
+    }
+}
+
+void SV5WMock::frameComplete(uint64_t atUs)
+{
+    ++rxFrames;
+    execute(atUs + latencyUs);
+}
+
+void SV5WMock::execute(uint64_t atUs)
+{
+    const uint16_t arg16 = (len >= 2) ? (uint16_t)((data[0] << 8) | data[1]) : 0;
+    switch ((Command)cmd) {
+        // --- control
+        case Command::PLAY:
+            if (status == Paused) { status = Playing; playStartUs = atUs; }
+            else if (status == Stopped) startTrack(atUs, track);
+            break;
+        case Command::PAUSE:
+            if (status == Playing) { playedUs += atUs - playStartUs; status = Paused; }
+            break;
+        case Command::STOP:
+        case Command::STOP_PLAYING:
+            status = Stopped;
+            break;
+        case Command::PREVIOUS:
+        case Command::PREVIOUS_FILE:
+            startTrack(atUs, track > 1 ? track - 1 : trackCount);
+            break;
+        case Command::NEXT:
+        case Command::NEXT_FILE:
+            startTrack(atUs, track < trackCount ? track + 1 : 1);
+            break;
+        case Command::VOL_UP:   if (vol < 30) ++vol; break;
+        case Command::VOL_DOWN: if (vol > 0) --vol; break;
+
+        // --- settings
+        case Command::SET_VOLUME:    if (len >= 1) vol = data[0] > 30 ? 30 : data[0]; break;
+        case Command::SET_LOOP_MODE: if (len >= 1) loopMode = data[0]; break;
+        case Command::SET_EQ:        if (len >= 1) eq = data[0]; break;
+        case Command::SET_CYCLE_TIMES: break;
+        case Command::SPECIFIED_SONG:
+        case Command::SPECIFIED_SONG_INTERPLAY:
+            startTrack(atUs, (Command)cmd == Command::SPECIFIED_SONG ? arg16
+                                                                 : (uint16_t)((data[1] << 8) | data[2]));
+            break;
+        case Command::SPECIFIED_PATH:
+        case Command::SPECIFIED_PATH_INTERPLAY:
+            if (len >= 1) drive = data[0];
+            startTrack(atUs, track); // pad -> index is onbekend; speel met standaardlengte
+            break;
+        case Command::SWITCH_SPECIFIED_DRIVE: if (len >= 1) drive = data[0]; break;
+        case Command::SELECT_NO_PLAY:
+            if (arg16 >= 1 && arg16 <= trackCount) track = arg16;
+            status = Stopped;
+            break;
+
+        // --- queries
+        case Command::QUERY_PLAY_STATUS: {
+            uint8_t st = (uint8_t)status;
+            reply(atUs, cmd, &st, 1);
+            break;
+        }
+        case Command::QUERY_CURRENT_ONLINE_DRIVE: {
+            uint8_t d = (uint8_t)(1u << drive);
+            reply(atUs, cmd, &d, 1);
+            break;
+        }
+        case Command::QUERY_CURRENT_PLAY_DRIVE:
+            reply(atUs, cmd, &drive, 1);
+            break;
+        case Command::QUERY_NUMBER_OF_SONGS:   reply16(atUs, cmd, trackCount); break;
+        case Command::QUERY_CURRENT_SONG:      reply16(atUs, cmd, track); break;
+        case Command::QUERY_FOLDER_DIR_SONG:   reply16(atUs, cmd, 1); break;
+        case Command::QUERY_FOLDER_SONG_COUNT: reply16(atUs, cmd, trackCount); break;
+        case Command::QUERY_VERSION: {
+            static const uint8_t ver[] = { 0x01, 0x02, 0x00 };
+            reply(atUs, cmd, ver, sizeof(ver));
+            break;
+        }
+    }
+}
+
+void SV5WMock::startTrack(uint64_t atUs, uint16_t index)
+{
+    if (index < 1) index = 1;
+    if (index > trackCount) index = trackCount;
+    track = index;
+    status = Playing;
+    playStartUs = atUs;
+    playedUs = 0;
+}
+
+void SV5WMock::reply16(uint64_t atUs, uint8_t c, uint16_t v)
+{
+    uint8_t d[2] = { (uint8_t)(v >> 8), (uint8_t)v };
+    reply(atUs, c, d, 2);
+}
+
+void SV5WMock::reply(uint64_t atUs, uint8_t c, const uint8_t* d, uint8_t n)
+{
+    uint8_t frame[SV5W::kMaxFrame];
+    uint8_t cs = (uint8_t)(0xAA + c + n);
+    frame[0] = 0xAA;
+    frame[1] = c;
+    frame[2] = n;
+    for (uint8_t i = 0; i < n; ++i) { frame[3 + i] = d[i]; cs += d[i]; }
+    frame[3 + n] = cs;
+    size_t total = 4u + n;
+
+    if (chance(corruptRate)) { frame[3 + n] ^= 0x5A; ++corrupted; }
+    if (chance(partialRate)) { total = 1 + (size_t)(rng % (total - 1)); ++partials; }
+
+    uint64_t t = atUs > replyFreeUs ? atUs : replyFreeUs;
+    for (size_t i = 0; i < total && outCount < kOutMax; ++i) {
+        t += byteUs;
+        out[(outHead + outCount) % kOutMax] = { t, frame[i] };
+        ++outCount;
+    }
+    replyFreeUs = t;
+    ++replies;
+}
+
+bool SV5WMock::chance(float p)
+{
+    if (p <= 0.0f) return false;
+    rng ^= rng >> 12; rng ^= rng << 25; rng ^= rng >> 27;
+    uint32_t r = (uint32_t)((rng * 0x2545F4914F6CDD1Dull) >> 40); // 24 bits
+    return (float)r < p * 16777216.0f;
+}
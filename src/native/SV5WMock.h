@@ -0,0 +1,83 @@
+// --- file: SV5WMock.h
+#pragma once
+#include "Hal.h"
+#include "SV5W.h"
+
+// Host-side emulatie van de DY-SV5W (UART-modus) voor de native build.
+// - Ontvangt de frames die SV5W schrijft, met draadtijd op de virtuele klok (10 bits/byte).
+// - Beantwoordt de queries uit SV5W::Command en houdt volume/track/afspeelstatus bij.
+// - Stuurt de BUSY-pin (actief LOW) op basis van de tracklengte.
+// - Kan fouten injecteren: corrupte checksums en afgekapte (partiële) antwoorden.
+class SV5WMock : public Hal::ByteStream {
+public:
+    using Command = SV5W::Command;
+
+    explicit SV5WMock(uint32_t baud = 9600, int busyPin = -1);
+
+    // --- Hal::ByteStream (kant van de driver)
+    int available() override;
+    int read() override;
+    size_t write(uint8_t b) override;
+
+    // Laat de tijd doorwerken: track-einde en BUSY-pin. Aanroepen na elke stap van de virtuele klok.
+    void update();
+
+    // --- configuratie
+    void setTrackCount(uint16_t n) { trackCount = n ? n : 1; }
+    void setTrackLengthMs(uint32_t ms) { trackLenMs = ms; }       // zelfde lengte voor alle tracks
+    void setReplyLatencyUs(uint32_t us) { latencyUs = us; }       // verwerkingstijd module
+    void setBusyDelayMs(uint32_t ms) { busyDelayMs = ms; }        // play -> BUSY actief
+    void setCorruptChecksumRate(float p) { corruptRate = p; }     // kans per antwoord
+    void setPartialFrameRate(float p) { partialRate = p; }        // kans per antwoord
+    void seed(uint64_t s) { rng = s ? s : 1; }
+
+    // --- toestand
+    uint8_t volume() const { return vol; }
+    uint16_t currentTrack() const { return track; }
+    bool isPlaying() const { return status == Playing; }
+
+    // --- tellers
+    uint32_t framesReceived() const { return rxFrames; }
+    uint32_t badFrames() const { return rxBad; }
+    uint32_t repliesSent() const { return replies; }
+    uint32_t corruptedReplies() const { return corrupted; }
+    uint32_t partialReplies() const { return partials; }
+    uint64_t bytesReceived() const { return rxBytes; }
+
+private:
+    enum Status : uint8_t { Stopped = 0, Playing = 1, Paused = 2 };
+
+    struct TimedByte { uint64_t atUs; uint8_t b; };
+
+    uint32_t byteUs;          // draadtijd per byte
+    int busyPin;
+    uint64_t lineFreeUs = 0;  // driver -> module: lijn bezet tot
+    uint64_t replyFreeUs = 0; // module -> driver: lijn bezet tot
+    static constexpr size_t kOutMax = 2048;   // vaste ring: de mock zelf alloceert ook niet
+    TimedByte out[kOutMax];    // antwoorden, beschikbaar vanaf atUs
+    size_t outHead = 0, outCount = 0;
+
+    // parser (zelfde state machine als de driver)
+    uint8_t stage = 0, cmd = 0, len = 0, sum = 0, pos = 0;
+    uint8_t data[SV5W::kMaxPayload];
+
+    // apparaatstatus
+    Status status = Stopped;
+    uint8_t vol = 20, eq = 0, loopMode = 0, drive = 0x01;
+    uint16_t track = 1, trackCount = 20;
+    uint32_t trackLenMs = 30000, latencyUs = 2000, busyDelayMs = 20;
+    uint64_t playStartUs = 0, playedUs = 0;
+
+    float corruptRate = 0.0f, partialRate = 0.0f;
+    uint64_t rng = 0x2545F4914F6CDD1Dull;
+
+    uint32_t rxFrames = 0, rxBad = 0, replies = 0, corrupted = 0, partials = 0;
+    uint64_t rxBytes = 0;
+
+    void frameComplete(uint64_t atUs);
+    void execute(uint64_t atUs);
+    void reply(uint64_t atUs, uint8_t c, const uint8_t* d, uint8_t n);
+    void reply16(uint64_t atUs, uint8_t c, uint16_t v);
+    void startTrack(uint64_t atUs, uint16_t index);
+    bool chance(float p);
+};
@@ -0,0 +1,981 @@
+// --- file: SimMain.cpp
+// Native simulator: draait de licht-engine tegen de virtuele klok van de HAL.
+// Gebruik:  pio run -e native && .pio/build/native/program [--hours H] [--seed S] [--step MS] [--bench ledset|sv5w|day|staticset|wake|spsc|buttons|rng|pca|ws2812|strike]
+//           .pio/build/native/program --golden check|record [--golden-dir DIR]   (zie GoldenTrace.h)
+// Onder 'pio test' (PIO_UNIT_TESTING) levert de test zelf main(); de simulator doet dan niet mee.
+#ifndef PIO_UNIT_TESTING
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "Hal.h"
+#include "Config.h"
+#include "LedPwm.h"
+#include "LedSet.h"
+#include "StaticLedSet.h"
+#include "Compositor.h"
+#include "LightProgram.h"
+#include "BlinkOverlay.h"
+#include "Button.h"
+#include "WakeScheduler.h"
+#include "Rng.h"
+#include "SpscRing.h"
+#include "SV5W.h"
+#include "SV5WMock.h"
+#include "GoldenTrace.h"
+#include "Pca9685.h"
+#include "FakeI2c.h"
+#include "Ws2812.h"
+#include "RmtSink.h"
+#include "StrikeField.h"
+
+namespace {
+
+// Zelfde stroom als Mode::Thunder in main.cpp: 'program --seed <gelogde seed>' speelt de storm van het apparaat na
+constexpr uint32_t kThunderStream = 0;
+
+// Afstandstabellen van Config::LED_POS, zoals gStrikeField in main.cpp
+const StrikeField& ledField() {
+    static StrikeField field(Config::LED_POS, Config::LED_COUNT, Config::LEDSET_THUNDER_WEIGHTS);
+    return field;
+}
+
+struct SimOptions {
+    double hours = 1.0;     // gesimuleerde stormuren
+    uint64_t seed = 1;      // RNG-seed (reproduceerbaar)
+    uint32_t stepMs = 1;    // virtuele tijd per loop()-iteratie
+    bool fixedStep = false; // storm: --step gezet = vaste stap i.p.v. naar de eerstvolgende deadline
+    const char* bench = nullptr; // naam van een microbenchmark i.p.v. de storm-simulatie
+    uint32_t queries = 100000;   // --bench sv5w: aantal queries
+    float faults = 0.0f;         // --bench sv5w: kans op corrupte checksum / partieel frame per antwoord
+    uint64_t messages = 20000000; // --bench spsc: berichten per run
+    uint32_t presses = 5000;      // --bench buttons: aantal knopdrukken
+    int pixels = 300;             // --bench ws2812/strike: aantal pixels/kanalen
+    const char* golden = nullptr; // check|record: golden traces i.p.v. de storm-simulatie
+    const char* goldenDir = "src/native/golden";
+};
+
+SimOptions parseArgs(int argc, char** argv) {
+    SimOptions o;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--hours") && i + 1 < argc) o.hours = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) o.seed = strtoull(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--step") && i + 1 < argc) { o.stepMs = (uint32_t)atoi(argv[++i]); o.fixedStep = true; }
+        else if (!strcmp(argv[i], "--bench") && i + 1 < argc) o.bench = argv[++i];
+        else if (!strcmp(argv[i], "--queries") && i + 1 < argc) o.queries = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--faults") && i + 1 < argc) o.faults = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--messages") && i + 1 < argc) o.messages = strtoull(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--presses") && i + 1 < argc) o.presses = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--pixels") && i + 1 < argc) o.pixels = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--golden") && i + 1 < argc) o.golden = argv[++i];
+        else if (!strcmp(argv[i], "--golden-dir") && i + 1 < argc) o.goldenDir = argv[++i];
+        else {
+            printf("Onbekend argument: %s\n", argv[i]);
+            printf("Gebruik: %s [--hours H] [--seed S] [--step MS] [--bench ledset|sv5w|day|staticset|wake|spsc|buttons|rng|pca|ws2812|strike [--queries N] [--faults P] [--messages N] [--presses N] [--pixels N]] [--golden check|record [--golden-dir DIR]]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (o.stepMs == 0) o.stepMs = 1;
+    return o;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Float- vs Q16-schaling zoals in LedSet::setOneScaledMasked, over een duty-stroom zo lang als een
+// storm van opt.hours bij 1 kHz. Alleen de schaling wordt gemeten (naar een array, geen FrameLayer of
+// commit); dat Q16 binnen 1 duty-stap van de float-referentie blijft, controleert test/test_ledset.
+int benchLedSet(const SimOptions& opt, LedPwmChannel** leds) {
+    const int n = Config::LED_COUNT;
+    const float overlay = 0.8f;
+    FrameLayer layer(n, leds[0]->maxDuty());
+    LedSet set(layer, Config::LEDSET_THUNDER_WEIGHTS);
+    set.setOverlay(overlay);
+
+    // kopieën op de heap: de compiler mag de Config-weights niet in de lus vouwen
+    std::vector<float> w(Config::LEDSET_THUNDER_WEIGHTS, Config::LEDSET_THUNDER_WEIGHTS + n);
+    std::vector<uint32_t> mul(n);
+    for (int i = 0; i < n; ++i) mul[i] = set.multiplierQ16(i);
+    std::vector<uint16_t> duties(4096), out(n);
+    Hal::sim::seedRandom(opt.seed);
+    for (uint16_t& d : duties) d = (uint16_t)(Hal::random32() % (set.maxDuty() + 1u));
+
+    const uint64_t frames = (uint64_t)(opt.hours * 3600.0 * 1000.0);
+    volatile uint32_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t f = 0; f < frames; ++f) {
+        uint16_t duty = duties[f & 4095];
+        for (int i = 0; i < n; ++i) {
+            if (w[i] <= 0.0f) continue;
+            uint32_t d = (uint32_t)(w[i] * duty);
+            d = (uint32_t)(overlay * d);
+            out[i] = (uint16_t)(d > 65535u ? 65535u : d);
+        }
+        sink = sink + out[f % n];
+    }
+    double tFloat = secondsSince(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    for (uint64_t f = 0; f < frames; ++f) {
+        uint16_t duty = duties[f & 4095];
+        for (int i = 0; i < n; ++i) {
+            if (w[i] <= 0.0f) continue;
+            out[i] = (uint16_t)(((uint32_t)duty * mul[i]) >> 16);
+        }
+        sink = sink + out[f % n];
+    }
+    double tQ16 = secondsSince(t0);
+
+    double calls = (double)frames * n;
+    printf("ledset bench    : %.2f h @1 kHz, %llu frames x %d kanalen, alleen de schaling\n",
+           opt.hours, (unsigned long long)frames, n);
+    printf("float pad       : %.3f s (%.2f ns/kanaal)\n", tFloat, tFloat * 1e9 / calls);
+    printf("Q16 pad         : %.3f s (%.2f ns/kanaal)\n", tQ16, tQ16 * 1e9 / calls);
+    return sink == 0xFFFFFFFFu ? 1 : 0;
+}
+
+// Eén set-implementatie een storm lang laten schrijven (setAllScaledMasked, 1 kHz); geeft seconden terug
+template <class Set>
+double timeMaskedWrites(Set& set, uint64_t frames, uint64_t seed) {
+    const uint32_t maxv = set.maxDuty();
+    uint64_t x = seed | 1;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t f = 0; f < frames; ++f) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;       // goedkope duty-stroom, buiten Hal::random32
+        set.setAllScaledMasked((uint16_t)(x % (maxv + 1u)));
+    }
+    return secondsSince(t0);
+}
+
+// LedSet (runtime n/weights/masker) vs. StaticLedSet<N, W> (compile-time), voor de thunder- en blink-weights.
+// Alleen tijd; dat de uitvoer bit-identiek is controleert test/test_staticset.
+template <const float (&W)[Config::LED_COUNT]>
+void benchStaticSetFor(const char* name, uint64_t frames, uint64_t seed, uint16_t maxv) {
+    FrameLayer dynLayer(Config::LED_COUNT, maxv), statLayer(Config::LED_COUNT, maxv);
+    LedSet dyn(dynLayer, W);
+    StaticLedSet<Config::LED_COUNT, W> stat(statLayer);
+
+    double tDyn = timeMaskedWrites(dyn, frames, seed);
+    double tStat = timeMaskedWrites(stat, frames, seed);
+
+    int active = 0;
+    for (int i = 0; i < Config::LED_COUNT; ++i) active += W[i] > 0.0f;
+    printf("%-8s (%d/%d)   : LedSet %.2f ns, StaticLedSet %.2f ns per setAllScaledMasked (%.1fx)\n",
+           name, active, Config::LED_COUNT, tDyn * 1e9 / (double)frames, tStat * 1e9 / (double)frames,
+           tStat > 0 ? tDyn / tStat : 0.0);
+}
+
+int benchStaticSet(const SimOptions& opt, LedPwmChannel** leds) {
+    const uint64_t frames = (uint64_t)(opt.hours * 3600.0 * 1000.0);
+    const uint16_t maxv = leds[0]->maxDuty();
+    printf("staticset bench : %.2f h @1 kHz, %llu aanroepen per set\n", opt.hours, (unsigned long long)frames);
+    benchStaticSetFor<Config::LEDSET_THUNDER_WEIGHTS>("thunder", frames, opt.seed, maxv);
+    benchStaticSetFor<Config::LEDSET_DAY_WEIGHTS>("day", frames, opt.seed, maxv);
+    benchStaticSetFor<Config::LEDSET_BLINK_WEIGHTS>("blink", frames, opt.seed, maxv);
+    return 0;
+}
+
+struct WakeRun {
+    uint64_t wakeups = 0, flashes = 0, writes = 0;
+    uint32_t bursts = 0, worstPressMs = 0;
+    double seconds = 0;
+};
+
+// Storm zoals in main() (thunder + knipper-overlay + NEXT-knop): elke ms pollen, of slapen tot de
+// eerstvolgende deadline (WakeScheduler + Hal::waitUntil). De knop wordt elke 5 min 120 ms ingedrukt;
+// in de slaapvariant wekt alleen de knopgebeurtenis (timer-callback na de flank) de loop.
+WakeRun runWakeStorm(const SimOptions& opt, LedPwmChannel** leds, bool sleep) {
+    Hal::sim::reset();
+    Hal::sim::seedRandom(opt.seed);
+    for (int i = 0; i < Config::LED_COUNT; ++i) { leds[i]->begin(); leds[i]->resetCounters(); }
+
+    Compositor frame(leds, Config::LED_COUNT);
+    FrameLayer thunderLayer(Config::LED_COUNT, leds[0]->maxDuty());
+    FrameLayer blinkLayer(Config::LED_COUNT, leds[0]->maxDuty());
+    frame.addLayer(&thunderLayer);
+    frame.addLayer(&blinkLayer);
+    LedSet thunderSet(thunderLayer, Config::LEDSET_THUNDER_WEIGHTS);
+    StaticLedSet<Config::LED_COUNT, Config::LEDSET_BLINK_WEIGHTS> blinkSet(blinkLayer);
+    ProgThunder thunder(thunderSet, Config::LEDSET_THUNDER_WEIGHTS, &ledField());
+    thunder.seed(Rng::derive(opt.seed, kThunderStream));
+    BlinkOverlay blink;
+    Button btn(Config::PIN_BTN_NEXT, true);
+    btn.begin();
+    WakeScheduler wake;
+
+    const uint64_t kPressEveryUs = 5ull * 60 * 1000000;
+    const uint64_t kPressUs = 120000;
+    uint64_t pressAtUs = kPressEveryUs;
+    Hal::sim::schedulePin(Config::PIN_BTN_NEXT, LOW, pressAtUs);
+    Hal::sim::schedulePin(Config::PIN_BTN_NEXT, HIGH, pressAtUs + kPressUs);
+
+    uint32_t now = Hal::millis();
+    thunder.start(now);
+    blink.start(now, 500, 50, 1.0f, 0.0f);
+
+    const int probeCh = Config::LEDC_CH[0];
+    bool wasLit = false;
+    WakeRun r;
+    const uint64_t totalUs = (uint64_t)(opt.hours * 3600.0 * 1000.0) * 1000u;
+    auto t0 = std::chrono::steady_clock::now();
+    while (Hal::sim::micros64() < totalUs) {
+        now = Hal::millis();
+        ButtonEvent ev;
+        while (btn.pop(ev)) {
+            if (ev.kind != ButtonEvent::Press) continue;
+            uint32_t lat = (uint32_t)((Hal::sim::micros64() - pressAtUs) / 1000u);
+            if (lat > r.worstPressMs) r.worstPressMs = lat;
+            pressAtUs += kPressEveryUs;
+            Hal::sim::schedulePin(Config::PIN_BTN_NEXT, LOW, pressAtUs);
+            Hal::sim::schedulePin(Config::PIN_BTN_NEXT, HIGH, pressAtUs + kPressUs);
+        }
+        thunder.update(now);
+        blink.update(now, blinkSet);
+        frame.commit(now);
+
+        bool lit = Hal::sim::pwmDuty(probeCh) > 0;
+        if (lit && !wasLit) ++r.flashes;
+        wasLit = lit;
+
+        if (sleep) {
+            wake.reset(now);
+            wake.request(thunder.nextWakeIn(now));
+            wake.request(blink.nextWakeIn(now));
+            wake.request(frame.nextWakeIn(now));
+            wake.sleep();
+            if (wake.delay() == 0) Hal::sim::advance(1); // 'direct weer': op hardware kost de loop zelf ook tijd
+        } else {
+            ++r.wakeups;
+            Hal::sim::advance(opt.stepMs);
+        }
+    }
+    r.seconds = secondsSince(t0);
+    if (sleep) r.wakeups = wake.wakeups();
+    r.bursts = thunder.burstsStarted();
+    for (int i = 0; i < Config::LED_COUNT; ++i) r.writes += Hal::sim::pwmWrites(Config::LEDC_CH[i]);
+    return r;
+}
+
+// Wakeups per minuut: continu pollen (1 kHz) vs. deadline-scheduler. Dat beide dezelfde lichtuitvoer
+// geven en elke druk aankomt, controleert test/test_wake.
+int benchWake(const SimOptions& opt, LedPwmChannel** leds) {
+    WakeRun poll = runWakeStorm(opt, leds, false);
+    WakeRun ev = runWakeStorm(opt, leds, true);
+    double minutes = opt.hours * 60.0;
+    printf("wake bench      : %.2f h storm + knipper-overlay, seed %llu\n", opt.hours, (unsigned long long)opt.seed);
+    auto row = [&](const char* name, const WakeRun& r) {
+        printf("%-16s: %10.1f wakeups/min, %u bursts, %llu flitsen, %llu ledcWrite, knop max %u ms, %.3f s\n",
+               name, minutes > 0 ? (double)r.wakeups / minutes : 0.0, r.bursts,
+               (unsigned long long)r.flashes, (unsigned long long)r.writes, r.worstPressMs, r.seconds);
+    };
+    row("pollen (1 kHz)", poll);
+    row("deadlines", ev);
+    printf("minder wakeups  : %.1fx\n", ev.wakeups ? (double)poll.wakeups / (double)ev.wakeups : 0.0);
+    return 0;
+}
+
+// Bericht zoals de opdrachten van main.cpp (8 bytes)
+struct SpscMsg {
+    uint32_t seq;
+    uint32_t check;
+};
+
+struct SpscRun {
+    uint64_t messages = 0, fullSpins = 0;
+    double seconds = 0;
+    std::vector<uint32_t> pushNs;   // steekproef van push()-duur (elk 64e bericht)
+};
+
+// Wachten op de andere kant: eerst yield, daarna kort slapen (op een host met 1 core komt de
+// andere thread anders pas na een hele tijdslice aan de beurt)
+struct Backoff {
+    int n = 0;
+    void pause() {
+        if (++n < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    void reset() { n = 0; }
+};
+
+// Eén producent- en één consumentthread over een SpscRing<SpscMsg, N>; is de ring vol of leeg, dan
+// wacht die kant (Backoff). Volgorde en inhoud controleert test/test_spsc.
+template <size_t N>
+SpscRun runSpsc(uint64_t count) {
+    static SpscRing<SpscMsg, N> ring;       // static: leeg na de vorige run (head == tail)
+    SpscRun r;
+    r.messages = count;
+    r.pushNs.reserve((size_t)(count / 64 + 1));
+    std::atomic<bool> go{false};
+
+    std::thread consumer([&] {
+        Backoff wait;
+        while (!go.load(std::memory_order_acquire)) wait.pause();
+        uint64_t got = 0;
+        SpscMsg m;
+        while (got < count) {
+            if (!ring.pop(m)) { wait.pause(); continue; }
+            wait.reset();
+            ++got;
+        }
+    });
+
+    auto t0 = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    Backoff wait;
+    for (uint64_t i = 0; i < count; ++i) {
+        SpscMsg m{ (uint32_t)i, (uint32_t)i * 2654435761u ^ 0xA5A5A5A5u };
+        if ((i & 63) == 0) {
+            // alleen de geslaagde push() telt; wachten op ruimte staat apart in fullSpins
+            auto a = std::chrono::steady_clock::now();
+            while (!ring.push(m)) { ++r.fullSpins; wait.pause(); a = std::chrono::steady_clock::now(); }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - a).count();
+            r.pushNs.push_back((uint32_t)ns);
+        } else {
+            while (!ring.push(m)) { ++r.fullSpins; wait.pause(); }
+        }
+        wait.reset();
+    }
+    consumer.join();
+    r.seconds = secondsSince(t0);
+    return r;
+}
+
+uint32_t percentile(std::vector<uint32_t>& v, double p) {
+    if (v.empty()) return 0;
+    size_t k = (size_t)(p * (double)(v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + (ptrdiff_t)k, v.end());
+    return v[k];
+}
+
+template <size_t N>
+void benchSpscFor(uint64_t count) {
+    SpscRun r = runSpsc<N>(count);
+    uint32_t p50 = percentile(r.pushNs, 0.50), p99 = percentile(r.pushNs, 0.99);
+    uint32_t worst = r.pushNs.empty() ? 0 : *std::max_element(r.pushNs.begin(), r.pushNs.end());
+    printf("N = %-5zu       : %6.1f M berichten/s, push p50 %u ns / p99 %u ns / max %u ns, %llu x vol\n",
+           N, r.seconds > 0 ? (double)r.messages / r.seconds / 1e6 : 0.0, p50, p99, worst,
+           (unsigned long long)r.fullSpins);
+}
+
+// Doorvoer van de SPSC-ring met echte threads (host); de push-latency is gemeten
+// inclusief wachten als de ring vol is (de 'vol'-teller laat zien hoe vaak dat gebeurde).
+int benchSpsc(const SimOptions& opt) {
+    printf("spsc bench      : %llu berichten van %zu bytes, 1 producent + 1 consument, %u hw-threads\n",
+           (unsigned long long)opt.messages, sizeof(SpscMsg), std::thread::hardware_concurrency());
+    benchSpscFor<16>(opt.messages);    // zoals de render-queue in main.cpp
+    benchSpscFor<1024>(opt.messages);
+    return 0;
+}
+
+// Eén knopdruk met contactdender: elke flank stuitert 0..4 keer binnen ~6 ms voor hij stabiel is
+void scheduleBouncyEdge(int pin, int level, uint64_t atUs) {
+    int bounces = (int)(Hal::random32() % 5);
+    uint64_t t = atUs;
+    for (int b = 0; b < bounces; ++b) {
+        Hal::sim::schedulePin(pin, level, t);
+        t += 200 + Hal::random32() % 1300;
+        Hal::sim::schedulePin(pin, !level, t);
+        t += 200 + Hal::random32() % 1300;
+    }
+    Hal::sim::schedulePin(pin, level, t);
+}
+
+// Snel herhaalde volumedrukken (60..150 ms los, 40..120 ms ingedrukt, met dender) plus af en toe
+// vasthouden (0.7..2 s); de I/O-taak slaapt tussen gebeurtenissen en is elke 2 s 250 ms bezig (geen
+// pop). Meet latency en kosten per druk, en ter vergelijking hoeveel drukken een enkel pressedEvent-bit
+// (oude Button) zou verliezen als er per verwerkingsronde meer dan één binnenkwam. Dat elke druk
+// precies één keer aankomt, controleert test/test_buttons.
+int benchButtons(const SimOptions& opt) {
+    Hal::sim::reset();
+    Hal::sim::seedRandom(opt.seed);
+    const int pin = Config::PIN_BTN_VOL_UP;
+    Button btn(pin, true, true);
+    btn.begin();
+    WakeScheduler wake;
+
+    const uint32_t kHoldEvery = 25;
+    const uint32_t kStallEveryMs = 2000, kStallMs = 250;
+    uint32_t scheduled = 0, holds = 0;
+    uint64_t startUs = 100000;
+    uint64_t presses = 0, releases = 0, oldLost = 0;
+    uint32_t worstLatencyMs = 0, worstStampErrMs = 0;
+    std::vector<uint64_t> pressAtUs;
+    uint32_t nextStallMs = kStallEveryMs;
+    bool stalled = false;
+
+    auto scheduleNext = [&]() {
+        bool hold = (scheduled + 1) % kHoldEvery == 0;
+        uint64_t downUs = hold ? 700000 + Hal::random32() % 1300000 : 40000 + Hal::random32() % 80000;
+        scheduleBouncyEdge(pin, LOW, startUs);
+        scheduleBouncyEdge(pin, HIGH, startUs + downUs);
+        pressAtUs.push_back(startUs);
+        if (hold) ++holds;
+        startUs += downUs + 60000 + Hal::random32() % 90000;
+        ++scheduled;
+    };
+    // volgende druk plannen zodra de vorige begonnen is (max. 2 drukken in de pinqueue)
+    auto feed = [&]() {
+        if (scheduled < opt.presses && Hal::sim::micros64() >= pressAtUs.back()) scheduleNext();
+    };
+    scheduleNext();
+
+    auto t0 = std::chrono::steady_clock::now();
+    // vangnet: stoppen als er 5 s na de laatste geplande druk nog releases ontbreken
+    while (releases < opt.presses && Hal::sim::micros64() < startUs + 5000000) {
+        uint32_t now = Hal::millis();
+        feed();
+
+        ButtonEvent ev;
+        uint32_t batchPresses = 0;
+        while (btn.pop(ev)) {
+            switch (ev.kind) {
+            case ButtonEvent::Press: {
+                uint64_t at = pressAtUs[presses++];
+                uint32_t lat = (uint32_t)((Hal::sim::micros64() - at) / 1000u);
+                uint32_t err = (uint32_t)(ev.ms - (uint32_t)(at / 1000u));
+                if (!stalled && lat > worstLatencyMs) worstLatencyMs = lat;
+                if (err > worstStampErrMs) worstStampErrMs = err;
+                ++batchPresses;
+                break;
+            }
+            case ButtonEvent::Release: ++releases; break;
+            default: break;
+            }
+        }
+        if (batchPresses > 1) oldLost += batchPresses - 1;
+        stalled = false;
+
+        if ((int32_t)(now - nextStallMs) >= 0) {
+            // bezig (UART, serial): ISR's en timers lopen door, niemand popt
+            for (uint32_t ms = 0; ms < kStallMs; ++ms) { Hal::delay(1); feed(); }
+            nextStallMs = now + kStallEveryMs;
+            stalled = true;
+            continue;
+        }
+        wake.reset(now);
+        if (scheduled < opt.presses) wake.request(WakeScheduler::until(now, (uint32_t)(pressAtUs.back() / 1000u) + 1));
+        wake.request(WakeScheduler::until(now, nextStallMs));
+        wake.sleep();
+    }
+    double secs = secondsSince(t0);
+    double simMin = Hal::sim::micros64() / 60e6;
+
+    printf("buttons bench   : %u drukken (%u vastgehouden), dender 0..4x per flank, seed %llu, %.1f min gesimuleerd\n",
+           opt.presses, holds, (unsigned long long)opt.seed, simMin);
+    printf("latency         : max %u ms tot pop (buiten stalls), tijdstempel max %u ms na de eerste flank\n",
+           worstLatencyMs, worstStampErrMs);
+    printf("kosten          : %.1f timer-callbacks en %.1f wakeups per druk, %.3f s\n",
+           (double)Hal::sim::timerFires() / opt.presses, (double)wake.wakeups() / opt.presses, secs);
+    printf("oude pressedEvent-bit: %llu van %llu drukken verloren (%.1f%%)\n",
+           (unsigned long long)oldLost, (unsigned long long)presses, presses ? 100.0 * oldLost / presses : 0.0);
+    return 0;
+}
+
+// Rng (xoshiro128** + Lemire) vs. de oude 'a + random32() % span':
+//  - snelheid van randRange(15, 60) op de host (Hal::random32 is hier een xorshift, op de ESP32 esp_random());
+//  - bias: bij span = 3 * 2^30 valt met % de helft van de trekkingen in het onderste derde (hoort 1/3).
+// Bereik, bias en reproduceerbare stormen controleert test/test_rng.
+int benchRng(const SimOptions& opt) {
+    const uint32_t kCalls = 50000000;
+    Hal::sim::seedRandom(opt.seed);
+    uint64_t sumOld = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kCalls; ++i) sumOld += 15 + (Hal::random32() % (60 - 15 + 1));
+    double oldNs = secondsSince(t0) * 1e9 / kCalls;
+
+    Rng rng(opt.seed);
+    uint64_t sumNew = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kCalls; ++i) sumNew += rng.range(15, 60);
+    double newNs = secondsSince(t0) * 1e9 / kCalls;
+
+    const uint32_t kSpan = 0xC0000000u, kDraws = 3000000;
+    uint32_t lowOld = 0, lowNew = 0;
+    for (uint32_t i = 0; i < kDraws; ++i) {
+        if (Hal::random32() % kSpan < kSpan / 3) ++lowOld;
+        if (rng.below(kSpan) < kSpan / 3) ++lowNew;
+    }
+
+    printf("rng bench       : seed %llu (0x%016llx)\n", (unsigned long long)opt.seed, (unsigned long long)opt.seed);
+    printf("randRange(15,60): %% %.2f ns/call (gem. %.2f), Rng %.2f ns/call (gem. %.2f)\n",
+           oldNs, (double)sumOld / kCalls, newNs, (double)sumNew / kCalls);
+    printf("bias (span 3*2^30): onderste derde %% %.4f, Rng %.4f (verwacht 0.3333)\n",
+           (double)lowOld / kDraws, (double)lowNew / kDraws);
+    return 0;
+}
+
+// Oude float-golf van ProgDay::update (referentie voor de LUT-benchmark)
+uint16_t floatDayBase(float& phase, uint16_t maxv) {
+    const float twoPi = 6.28318530718f;
+    phase += 0.055f;
+    if (phase > twoPi) phase -= twoPi;
+    float x1 = constrain(0.35f + 0.25f * (0.5f + 0.5f * sinf(phase)), 0.f, 1.f);
+    float x2 = constrain(0.35f + 0.25f * (0.5f + 0.5f * sinf(phase + 1.3f)), 0.f, 1.f);
+    return (uint16_t)(((uint16_t)(x1 * maxv) + (uint16_t)(x2 * maxv)) / 2);
+}
+
+uint16_t lutDayBase(uint32_t& phase, uint16_t maxv) {
+    phase += ProgDay::PhaseStep;
+    return (uint16_t)((ProgDay::waveDuty(phase, maxv) + ProgDay::waveDuty(phase + ProgDay::PhaseOffset2, maxv)) / 2);
+}
+
+uint64_t cycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// ProgDay-golf per tick (100 Hz): sinf + float-fase vs. LUT + 32-bit fase-accumulator. Alleen tijd;
+// nauwkeurigheid (1 duty-stap) en fasedrift controleert test/test_day.
+int benchDay(const SimOptions& opt, LedPwmChannel** leds) {
+    const uint64_t ticks = (uint64_t)(opt.hours * 3600.0 * 100.0);
+    const uint16_t maxv = leds[0]->maxDuty();
+    volatile uint32_t sink = 0;
+
+    float fPhase = 0.f;
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = cycleCounter();
+    for (uint64_t t = 0; t < ticks; ++t) sink = sink + floatDayBase(fPhase, maxv);
+    uint64_t cFloat = cycleCounter() - c0;
+    double tFloat = secondsSince(t0);
+
+    uint32_t iPhase = 0;
+    t0 = std::chrono::steady_clock::now();
+    c0 = cycleCounter();
+    for (uint64_t t = 0; t < ticks; ++t) sink = sink + lutDayBase(iPhase, maxv);
+    uint64_t cLut = cycleCounter() - c0;
+    double tLut = secondsSince(t0);
+
+    printf("day bench       : %.2f h @100 Hz, %llu ticks, maxDuty %u\n",
+           opt.hours, (unsigned long long)ticks, (unsigned)maxv);
+    printf("sinf + float    : %.3f s (%.2f ns/update", tFloat, tFloat * 1e9 / (double)ticks);
+    if (cFloat) printf(", %.1f cycli/update", (double)cFloat / (double)ticks);
+    printf(")\n");
+    printf("LUT + Q32-fase  : %.3f s (%.2f ns/update", tLut, tLut * 1e9 / (double)ticks);
+    if (cLut) printf(", %.1f cycli/update", (double)cLut / (double)ticks);
+    printf(")\n");
+    return sink == 0xFFFFFFFFu ? 1 : 0;
+}
+
+struct QueryProbe {
+    bool done = false;
+    bool valid = false;
+};
+
+void onQuery(const SV5W::Response& r, void* ctx) {
+    QueryProbe* p = (QueryProbe*)ctx;
+    p->done = true;
+    p->valid = r.valid;
+}
+
+// Round-trip van SV5W-queries tegen de mock bij 9600 baud (virtuele tijd) en doorvoer op de host.
+// Geldige antwoorden, herstel na fouten en 0 heap-allocaties controleert test/test_sv5w.
+int benchSv5w(const SimOptions& opt) {
+    static const SV5W::Command kQueries[] = {
+        SV5W::Command::QUERY_PLAY_STATUS, SV5W::Command::QUERY_VERSION,
+        SV5W::Command::QUERY_NUMBER_OF_SONGS, SV5W::Command::QUERY_CURRENT_SONG,
+        SV5W::Command::QUERY_CURRENT_PLAY_DRIVE, SV5W::Command::QUERY_FOLDER_SONG_COUNT,
+    };
+    const uint32_t stepUs = 100;
+
+    SV5WMock mock(Config::UART_BAUD, Config::PIN_BUSY);
+    mock.seed(opt.seed);
+    mock.setCorruptChecksumRate(opt.faults);
+    mock.setPartialFrameRate(opt.faults);
+    SV5W sv5w;
+    sv5w.begin(mock, Config::UART_BAUD);
+    sv5w.setVolume(20);
+    sv5w.playTrack(Config::TRACK_THUNDER);
+
+    uint64_t ok = 0, failed = 0, totalUs = 0, worstUs = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t q = 0; q < opt.queries; ++q) {
+        QueryProbe probe;
+        uint32_t issued = Hal::micros();
+        sv5w.sendQuery(kQueries[q % (sizeof(kQueries) / sizeof(kQueries[0]))], onQuery, &probe);
+        while (!probe.done) {
+            sv5w.poll(Hal::millis());
+            mock.update();
+            if (!probe.done) Hal::sim::advanceMicros(stepUs);
+        }
+        uint64_t rt = Hal::micros() - issued;
+        totalUs += rt;
+        if (rt > worstUs) worstUs = rt;
+        probe.valid ? ++ok : ++failed;
+    }
+    double wall = secondsSince(t0);
+
+    printf("sv5w bench      : %u queries @%u baud, faults %.3f\n",
+           (unsigned)opt.queries, (unsigned)Config::UART_BAUD, opt.faults);
+    printf("geldig/mislukt  : %llu / %llu (timeouts %u, rx-fouten %u)\n",
+           (unsigned long long)ok, (unsigned long long)failed,
+           (unsigned)sv5w.timeouts(), (unsigned)sv5w.rxErrors());
+    printf("round-trip      : gem %.2f ms, slechtst %.2f ms (virtueel)\n",
+           opt.queries ? totalUs / 1000.0 / opt.queries : 0.0, worstUs / 1000.0);
+    printf("mock            : %u frames, %u antwoorden (%u corrupt, %u partieel)\n",
+           (unsigned)mock.framesReceived(), (unsigned)mock.repliesSent(),
+           (unsigned)mock.corruptedReplies(), (unsigned)mock.partialReplies());
+    printf("wandtijd        : %.3f s (%.0f queries/s)\n", wall, wall > 0 ? opt.queries / wall : 0.0);
+    return 0;
+}
+
+// PCA9685: 64 kanalen onweer (4 borden) op de FakeI2cBus bij Config::I2C_FREQ. Eén burst per bord
+// per frame vs. de naïeve aanpak (elke gewijzigde uitgang een eigen transactie: adres + reg + 4 bytes).
+// Registers, retry na een NACK en het aantal transacties per frame controleert test/test_pca.
+int benchPca(const SimOptions& opt) {
+    constexpr int kBoards = Pca9685::kMaxChips;
+    constexpr int kCh = kBoards * Pca9685::kChannelsPerChip;
+    constexpr uint32_t kNaiveBytes = 1 + 1 + 4;
+    Hal::sim::reset();
+    FakeI2cBus bus(Config::I2C_FREQ);
+    for (int b = 0; b < kBoards; ++b) bus.addPca9685((uint8_t)(Config::PCA9685_ADDR + b));
+    Pca9685 pca(bus, Config::PCA9685_ADDR, kBoards);
+    pca.begin(Config::PCA9685_PWM_FREQ);
+
+    LedPwmChannel* chans[kCh];
+    for (int i = 0; i < kCh; ++i) {
+        chans[i] = new LedPwmChannel(pca, i, Config::PCA9685_PWM_FREQ, Config::LEDC_RES_BITS);
+        chans[i]->begin();
+    }
+    // weights aflopend over de borden, zoals de ketting LED's onder de wolk
+    float weights[kCh];
+    for (int i = 0; i < kCh; ++i) weights[i] = 1.0f - 0.9f * (float)i / (kCh - 1);
+    Compositor frame(chans, kCh);
+    FrameLayer layer(kCh, chans[0]->maxDuty());
+    frame.addLayer(&layer);
+    LedSet set(layer, weights);
+    ProgThunder thunder(set, weights);
+    thunder.seed(Rng::derive(opt.seed, kThunderStream));
+    thunder.start(Hal::millis());
+    bus.resetCounters();
+
+    const uint64_t totalMs = (uint64_t)(opt.hours * 3600.0 * 1000.0);
+    uint64_t busyFrames = 0, naiveTx = 0;
+    uint32_t worstUs = 0, worstNaiveUs = 0, prevIssued = 0;
+    for (uint64_t ms = 0; ms < totalMs; ++ms) {
+        uint32_t now = Hal::millis();
+        thunder.update(now);
+        uint64_t us0 = bus.busTimeUs();
+        frame.commit(now);
+        uint32_t frameUs = (uint32_t)(bus.busTimeUs() - us0);
+        if (frameUs) {
+            ++busyFrames;
+            if (frameUs > worstUs) worstUs = frameUs;
+            uint32_t issued = 0;
+            for (int i = 0; i < kCh; ++i) issued += chans[i]->writesIssued();
+            uint32_t changed = issued - prevIssued;
+            prevIssued = issued;
+            naiveTx += changed;
+            uint32_t naiveUs = changed * (uint32_t)((kNaiveBytes * 9 + 2) * 1000000ull / Config::I2C_FREQ);
+            if (naiveUs > worstNaiveUs) worstNaiveUs = naiveUs;
+        }
+        Hal::sim::advance(1);
+    }
+
+    double perFrame = busyFrames ? (double)bus.transactions() / busyFrames : 0.0;
+    printf("pca bench       : %.2f h onweer, %d kanalen op %d borden, I2C %u kHz, seed %llu\n",
+           opt.hours, kCh, kBoards, (unsigned)(Config::I2C_FREQ / 1000), (unsigned long long)opt.seed);
+    printf("frames met I2C  : %llu van %llu\n", (unsigned long long)busyFrames, (unsigned long long)totalMs);
+    printf("burst per bord  : %u transacties (%.2f/frame), %llu bytes (%.1f/frame), bus %.1f s, max %u us/frame\n",
+           bus.transactions(), perFrame, (unsigned long long)bus.bytes(),
+           busyFrames ? (double)bus.bytes() / busyFrames : 0.0, bus.busTimeUs() / 1e6, worstUs);
+    printf("per uitgang     : %llu transacties (%.2f/frame), %llu bytes, bus %.1f s, max %u us/frame\n",
+           (unsigned long long)naiveTx, busyFrames ? (double)naiveTx / busyFrames : 0.0,
+           (unsigned long long)(naiveTx * kNaiveBytes),
+           naiveTx * (double)((kNaiveBytes * 9 + 2) * 1000000ull / Config::I2C_FREQ) / 1e6, worstNaiveUs);
+    for (int i = 0; i < kCh; ++i) delete chans[i];
+    return 0;
+}
+
+// WS2812-strip zoals in main.cpp: een pixel-onweer (één kanaal per pixel, tint) volgt de bursts van
+// het gewone onweer op de 4 kanalen. Meet draadtijd, samengevoegde frames, render -> draad en de
+// commit-kosten; vergelijking: een blokkerende send() zou de render-taak laten wachten tot de draad
+// vrij is. Pulsvorm en frame-inhoud controleert test/test_ws2812.
+int benchWs2812(const SimOptions& opt, LedPwmChannel** leds) {
+    const int n = opt.pixels > 0 ? opt.pixels : 1;
+    const uint8_t tint[3] = { 190, 200, 255 };
+    Hal::sim::reset();
+
+    for (int i = 0; i < Config::LED_COUNT; ++i) leds[i]->begin();
+    Compositor frame(leds, Config::LED_COUNT);
+    FrameLayer layer(Config::LED_COUNT, leds[0]->maxDuty());
+    frame.addLayer(&layer);
+    LedSet set(layer, Config::LEDSET_THUNDER_WEIGHTS);
+    ProgThunder thunder(set, Config::LEDSET_THUNDER_WEIGHTS, &ledField());
+    thunder.seed(Rng::derive(opt.seed, kThunderStream));
+
+    RmtSink sink;
+    Ws2812Strip strip(sink, n, Ws2812Strip::Layout::Mono);
+    strip.setTint(tint[0], tint[1], tint[2]);
+    std::vector<LedPwmChannel*> px(n);
+    std::vector<float> weights(n, 1.0f);
+    for (int i = 0; i < n; ++i) {
+        px[i] = new LedPwmChannel(strip, i, 800000, Config::LEDC_RES_BITS);
+        px[i]->begin();
+    }
+    Compositor pixelFrame(px.data(), n);
+    FrameLayer pixelLayer(n, px[0]->maxDuty());
+    pixelFrame.addLayer(&pixelLayer);
+    LedSet pixelSet(pixelLayer, weights.data());
+    ProgThunder pixelStorm(pixelSet, weights.data());
+    pixelStorm.seed(Rng::derive(opt.seed, kThunderStream + 1));
+    pixelStorm.setCueSync(true);
+    thunder.setFollower(&pixelStorm);
+
+    uint32_t now = Hal::millis();
+    thunder.start(now);
+    pixelStorm.start(now);
+
+    const uint64_t totalMs = (uint64_t)(opt.hours * 3600.0 * 1000.0);
+    uint64_t stallUs = 0, stalledFrames = 0;
+    uint32_t sentBefore = 0, maxDelayMs = 0, pendingSince = 0;
+    bool pending = false;
+    double commitSec = 0.0;
+    for (uint64_t ms = 0; ms < totalMs; ++ms) {
+        now = Hal::millis();
+        thunder.update(now);
+        pixelStorm.update(now);
+        frame.commit(now);
+        // blokkerend zenden zou hier wachten tot de vorige frame + reset weg is
+        uint64_t busyUntil = sink.latchAtUs();
+        auto t0 = std::chrono::steady_clock::now();
+        pixelFrame.commit(now);
+        commitSec += secondsSince(t0);
+        uint64_t nowUs = Hal::sim::micros64();
+        if ((strip.framesSent() != sentBefore || strip.pending()) && busyUntil > nowUs) {
+            stallUs += busyUntil - nowUs;
+            ++stalledFrames;
+        }
+        if (strip.pending() && !pending) { pending = true; pendingSince = now; }
+        if (strip.framesSent() != sentBefore) {
+            sentBefore = strip.framesSent();
+            if (pending && now - pendingSince > maxDelayMs) maxDelayMs = now - pendingSince;
+            pending = strip.pending();
+            pendingSince = now;
+        }
+        Hal::sim::advance(1);
+    }
+
+    uint32_t frameUs = Ws2812::frameUs(strip.frameBytes());
+    printf("ws2812 bench    : %.2f h onweer, %d pixels (mono, tint %u/%u/%u), seed %llu\n",
+           opt.hours, n, tint[0], tint[1], tint[2], (unsigned long long)opt.seed);
+    printf("draad           : %u us/frame + %u us reset (max %.0f fps), %u refills/frame\n",
+           frameUs, Ws2812::kResetUs, 1e6 / (frameUs + Ws2812::kResetUs),
+           sink.frames() ? sink.refills() / sink.frames() : 0);
+    printf("bursts          : %u onweer, %u gevolgd door de strip\n", thunder.burstsStarted(), pixelStorm.burstsStarted());
+    printf("frames          : %u verzonden, %u samengevoegd (draad bezig), %.1f s op de draad\n",
+           strip.framesSent(), strip.framesMerged(), sink.wireUs() / 1e6);
+    printf("render -> draad : max %u ms vertraging, commit %.2f us/frame (host)\n",
+           maxDelayMs, totalMs ? commitSec * 1e6 / totalMs : 0.0);
+    printf("blokkerend      : %llu frames zouden wachten, %.1f s totaal (%.2f%% van de render-taak)\n",
+           (unsigned long long)stalledFrames, stallUs / 1e6, totalMs ? 100.0 * stallUs / 1e3 / totalMs : 0.0);
+    for (int i = 0; i < n; ++i) delete px[i];
+    return 0;
+}
+
+// Uitvoer zonder hardware (alleen tellen), voor kanaalaantallen boven de 16 gesimuleerde LEDC's
+struct NullPwm : PwmDriver {
+    uint64_t writes = 0;
+    void setup(int, int, uint32_t, uint8_t) override {}
+    void write(int, uint32_t) override { ++writes; }
+};
+
+// StrikeField op een raster van opt.pixels kanalen (5 cm), alleen tijd (de controles op volgorde,
+// vaste stappen en het stormmodel staan in test/test_strike):
+//  - tabellen: opbouwtijd en geheugen;
+//  - storm: ProgThunder::update per frame;
+//  - kosten per subflits: oude random skew (elke frame van FlashOn n nieuwe offsets, ~37 frames)
+//    vs. één pass over de tabelrij.
+int benchStrike(const SimOptions& opt) {
+    const int n = opt.pixels > 1 ? opt.pixels : 2;
+    const int cols = (int)ceil(sqrt(n * 4.0 / 3.0));
+    std::vector<Config::LedPos> pos(n);
+    for (int i = 0; i < n; ++i) pos[i] = { (i % cols) * 5.0f, (i / cols) * 5.0f, 20.0f + (i % 3) * 2.0f };
+
+    auto t0 = std::chrono::steady_clock::now();
+    StrikeField field(pos.data(), n);
+    double buildMs = secondsSince(t0) * 1e3;
+
+    // storm over n kanalen
+    Hal::sim::reset();
+    NullPwm out;
+    std::vector<LedPwmChannel*> chans(n);
+    for (int i = 0; i < n; ++i) {
+        chans[i] = new LedPwmChannel(out, i, 1000, Config::LEDC_RES_BITS);
+        chans[i]->begin();
+    }
+    std::vector<float> weights(n, 1.0f);
+    Compositor frame(chans.data(), n);
+    FrameLayer layer(n, chans[0]->maxDuty());
+    frame.addLayer(&layer);
+    LedSet set(layer, weights.data());
+    ProgThunder thunder(set, weights.data(), &field);
+    thunder.seed(Rng::derive(opt.seed, kThunderStream));
+    thunder.start(Hal::millis());
+
+    const uint64_t totalMs = (uint64_t)(opt.hours * 3600.0 * 1000.0);
+    double updateSec = 0.0;
+    for (uint64_t ms = 0; ms < totalMs; ++ms) {
+        uint32_t now = Hal::millis();
+        t0 = std::chrono::steady_clock::now();
+        thunder.update(now);
+        updateSec += secondsSince(t0);
+        frame.commit(now);
+        Hal::sim::advance(1);
+    }
+
+    // kosten per subflits: oud = ~37 frames x n random offsets, nieuw = 1 x tabelrij
+    const int kRuns = 2000, kFlashFrames = 37;
+    Rng rng(opt.seed);
+    std::vector<uint16_t> off(n), gain(n);
+    volatile uint32_t sink = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRuns; ++r)
+        for (int f = 0; f < kFlashFrames; ++f) {
+            for (int i = 0; i < n; ++i) off[i] = (uint16_t)rng.range(2, 22);
+            sink = sink + off[r % n];
+        }
+    double oldUs = secondsSince(t0) * 1e6 / kRuns;
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRuns; ++r) {
+        const uint8_t* row = field.row(r % StrikeField::kOrigins);
+        for (int i = 0; i < n; ++i) {
+            constexpr uint32_t kSpread = StrikeField::kSpreadSteps;
+            uint32_t d = row[i];
+            off[i] = (uint16_t)(2 + (20u * d + kSpread / 2) / kSpread);
+            gain[i] = (uint16_t)(256 - (102u * (d < kSpread ? d : kSpread) + kSpread / 2) / kSpread);
+        }
+        sink = sink + off[r % n] + gain[r % n];
+    }
+    double newUs = secondsSince(t0) * 1e6 / kRuns;
+
+    printf("strike bench    : %d kanalen (raster %d breed, 5 cm), %d inslagpunten, seed %llu\n",
+           n, cols, StrikeField::kOrigins, (unsigned long long)opt.seed);
+    printf("tabellen        : %zu bytes, opbouw %.2f ms (stappen van %.0f cm)\n",
+           field.tableBytes(), buildMs, StrikeField::kCmPerStep);
+    printf("storm %5.2f h   : %u bursts, update %.0f ns/frame\n",
+           opt.hours, thunder.burstsStarted(), totalMs ? updateSec * 1e9 / totalMs : 0.0);
+    printf("per subflits    : random skew %.2f us (%d frames x %d), tabel %.2f us (%.0fx minder)\n",
+           oldUs, kFlashFrames, n, newUs, newUs > 0 ? oldUs / newUs : 0.0);
+    for (int i = 0; i < n; ++i) delete chans[i];
+    return sink == 0xFFFFFFFFu ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    SimOptions opt = parseArgs(argc, argv);
+    Hal::sim::reset();
+    Hal::sim::seedRandom(opt.seed);
+
+    // Zelfde opbouw als setup() in main.cpp
+    LedPwmChannel* leds[Config::LED_COUNT];
+    for (int i = 0; i < Config::LED_COUNT; ++i) {
+        leds[i] = new LedPwmChannel(Config::LEDC_CH[i], Config::PIN_LED[i],
+                                    Config::LEDC_FREQ, Config::LEDC_RES_BITS);
+        leds[i]->begin();
+        leds[i]->setDuty(0);
+        leds[i]->commit();
+    }
+    if (opt.golden) return Golden::run(opt.golden, opt.goldenDir, leds);
+    if (opt.bench) {
+        if (!strcmp(opt.bench, "ledset")) return benchLedSet(opt, leds);
+        if (!strcmp(opt.bench, "sv5w")) return benchSv5w(opt);
+        if (!strcmp(opt.bench, "day")) return benchDay(opt, leds);
+        if (!strcmp(opt.bench, "staticset")) return benchStaticSet(opt, leds);
+        if (!strcmp(opt.bench, "wake")) return benchWake(opt, leds);
+        if (!strcmp(opt.bench, "spsc")) return benchSpsc(opt);
+        if (!strcmp(opt.bench, "buttons")) return benchButtons(opt);
+        if (!strcmp(opt.bench, "rng")) return benchRng(opt);
+        if (!strcmp(opt.bench, "pca")) return benchPca(opt);
+        if (!strcmp(opt.bench, "ws2812")) return benchWs2812(opt, leds);
+        if (!strcmp(opt.bench, "strike")) return benchStrike(opt);
+        printf("Onbekende benchmark: %s\n", opt.bench);
+        return 2;
+    }
+
+    Compositor frame(leds, Config::LED_COUNT);
+    FrameLayer thunderLayer(Config::LED_COUNT, leds[0]->maxDuty());
+    FrameLayer blinkLayer(Config::LED_COUNT, leds[0]->maxDuty());
+    frame.addLayer(&thunderLayer);
+    frame.addLayer(&blinkLayer);
+    LedSet thunderSet(thunderLayer, Config::LEDSET_THUNDER_WEIGHTS);
+    StaticLedSet<Config::LED_COUNT, Config::LEDSET_BLINK_WEIGHTS> blinkSet(blinkLayer);
+    ProgThunder thunder(thunderSet, Config::LEDSET_THUNDER_WEIGHTS, &ledField());
+    thunder.seed(Rng::derive(opt.seed, kThunderStream));
+    BlinkOverlay blink;
+
+    uint32_t now = Hal::millis();
+    thunder.start(now);
+    blink.start(now, 500, 50, 1.0f, 0.0f);
+
+    // Flitsen tellen op kanaal 0 (zwaarste thunder-weight): overgang 0 -> >0
+    const int probeCh = Config::LEDC_CH[0];
+    bool wasLit = false;
+    uint64_t flashes = 0, iterations = 0;
+
+    // Standaard van deadline naar deadline (WakeScheduler, zoals de render-taak): tussen twee deadlines
+    // verandert er niets. --step MS: vaste stap, elke iteratie update + commit.
+    WakeScheduler wake;
+    const uint64_t totalUs = (uint64_t)(opt.hours * 3600.0 * 1000.0) * 1000u;
+    auto t0 = std::chrono::steady_clock::now();
+    while (Hal::sim::micros64() < totalUs) {
+        now = Hal::millis();
+        thunder.update(now);
+        blink.update(now, blinkSet);
+        frame.commit(now);
+
+        bool lit = Hal::sim::pwmDuty(probeCh) > 0;
+        if (lit && !wasLit) ++flashes;
+        wasLit = lit;
+
+        ++iterations;
+        if (opt.fixedStep) {
+            Hal::sim::advance(opt.stepMs);
+            continue;
+        }
+        wake.reset(now);
+        wake.request(thunder.nextWakeIn(now));
+        wake.request(blink.nextWakeIn(now));
+        wake.request(frame.nextWakeIn(now));
+        wake.sleep();
+        if (wake.delay() == 0) Hal::sim::advance(1);
+    }
+    double wall = secondsSince(t0);
+
+    uint64_t writes = 0, requests = 0;
+    for (int i = 0; i < Config::LED_COUNT; ++i) {
+        writes += Hal::sim::pwmWrites(Config::LEDC_CH[i]);
+        requests += leds[i]->dutyRequests();
+    }
+
+    printf("seed            : %llu (0x%016llx)\n", (unsigned long long)opt.seed, (unsigned long long)opt.seed);
+    if (opt.fixedStep)
+        printf("gesimuleerd     : %.2f h (%llu iteraties, stap %u ms)\n",
+               opt.hours, (unsigned long long)iterations, (unsigned)opt.stepMs);
+    else
+        printf("gesimuleerd     : %.2f h (%llu iteraties, van deadline naar deadline)\n",
+               opt.hours, (unsigned long long)iterations);
+    printf("flitsen (ch %d)  : %llu\n", probeCh, (unsigned long long)flashes);
+    printf("setDuty totaal  : %llu\n", (unsigned long long)requests);
+    printf("ledcWrite totaal: %llu (%.1f%% onderdrukt)\n", (unsigned long long)writes,
+           requests ? 100.0 * (double)(requests - (writes < requests ? writes : requests)) / (double)requests : 0.0);
+    printf("wandtijd        : %.3f s (%.1f stormuren/s, %.1f ns/iteratie)\n",
+           wall, wall > 0 ? opt.hours / wall : 0.0,
+           iterations ? wall * 1e9 / (double)iterations : 0.0);
+    return 0;
+}
+
+#endif // PIO_UNIT_TESTING
@@ -0,0 +1,92 @@
+// --- file: StormFixture.h
+#pragma once
+// Gedeelde opbouw voor de tests in test/test_*/ (pio test -e native): dezelfde licht-engine als
+// main.cpp en de simulator (Compositor + FrameLayer + LedSet + ProgThunder), op de virtuele klok.
+// Alleen header: PlatformIO bouwt per test-map alleen die map mee.
+#include <vector>
+#include "Hal.h"
+#include "Config.h"
+#include "LedPwm.h"
+#include "LedSet.h"
+#include "Compositor.h"
+#include "LightProgram.h"
+#include "Rng.h"
+#include "StrikeField.h"
+
+namespace Fixture {
+
+// Zelfde stroom als Mode::Thunder in main.cpp (Rng::derive(seed, 0))
+constexpr uint32_t kThunderStream = 0;
+
+// Afstandstabellen van Config::LED_POS, zoals gStrikeField in main.cpp
+inline const StrikeField& ledField() {
+    static StrikeField field(Config::LED_POS, Config::LED_COUNT, Config::LEDSET_THUNDER_WEIGHTS);
+    return field;
+}
+
+// Uitvoer zonder hardware (alleen tellen), voor kanaalaantallen boven de 16 gesimuleerde LEDC's
+struct NullPwm : PwmDriver {
+    uint64_t writes = 0;
+    void setup(int, int, uint32_t, uint8_t) override {}
+    void write(int, uint32_t) override { ++writes; }
+};
+
+// Kanalen op een driver; zonder driver de LEDC-kanalen uit Config (na Hal::sim::reset())
+class Channels {
+public:
+    Channels() {
+        for (int i = 0; i < Config::LED_COUNT; ++i)
+            chans.push_back(new LedPwmChannel(Config::LEDC_CH[i], Config::PIN_LED[i],
+                                              Config::LEDC_FREQ, Config::LEDC_RES_BITS));
+        beginAll();
+    }
+    Channels(PwmDriver& drv, int n, uint32_t freq = 1000) {
+        for (int i = 0; i < n; ++i) chans.push_back(new LedPwmChannel(drv, i, freq, Config::LEDC_RES_BITS));
+        beginAll();
+    }
+    ~Channels() { for (LedPwmChannel* c : chans) delete c; }
+    Channels(const Channels&) = delete;
+    Channels& operator=(const Channels&) = delete;
+
+    LedPwmChannel** data() { return chans.data(); }
+    LedPwmChannel& operator[](int i) { return *chans[i]; }
+    int size() const { return (int)chans.size(); }
+
+private:
+    std::vector<LedPwmChannel*> chans;
+    void beginAll() { for (LedPwmChannel* c : chans) c->begin(); }
+};
+
+// Eén onweer-laag op een compositor: ProgThunder met de stroom van Mode::Thunder
+struct ThunderRig {
+    Compositor frame;
+    FrameLayer layer;
+    LedSet set;
+    ProgThunder thunder;
+
+    ThunderRig(Channels& ch, const float* weights, uint64_t seed, const StrikeField* field = nullptr,
+               uint32_t stream = kThunderStream)
+        : frame(ch.data(), ch.size()), layer(ch.size(), ch[0].maxDuty()), set(layer, weights),
+          thunder(set, weights, field) {
+        frame.addLayer(&layer);
+        thunder.seed(Rng::derive(seed, stream));
+    }
+
+    void start() { thunder.start(Hal::millis()); }
+    // één frame: programma, commit, klok 1 ms verder
+    void step() {
+        uint32_t now = Hal::millis();
+        thunder.update(now);
+        frame.commit(now);
+        Hal::sim::advance(1);
+    }
+};
+
+// Storm zoals in main.cpp op de LEDC-kanalen: thunder-weights en Config::LED_POS
+struct LedStorm {
+    Channels leds;
+    ThunderRig rig;
+    explicit LedStorm(uint64_t seed) : leds(), rig(leds, Config::LEDSET_THUNDER_WEIGHTS, seed, &ledField()) {}
+};
+
+}
@@ -0,0 +1,153 @@
+// --- file: test_buttons/test_main.cpp
+// Button (pin-ISR + timer-callback + SpscRing): snelle, denderende drukken en een taak die af en toe
+// 250 ms niet popt; elke druk moet er precies één keer uitkomen.
+#include <unity.h>
+#include <vector>
+#include "Hal.h"
+#include "Config.h"
+#include "Button.h"
+#include "WakeScheduler.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+// Eén flank met contactdender: 0..4 keer stuiteren binnen ~12 ms voor hij stabiel is
+void scheduleBouncyEdge(int pin, int level, uint64_t atUs) {
+    int bounces = (int)(Hal::random32() % 5);
+    uint64_t t = atUs;
+    for (int b = 0; b < bounces; ++b) {
+        Hal::sim::schedulePin(pin, level, t);
+        t += 200 + Hal::random32() % 1300;
+        Hal::sim::schedulePin(pin, !level, t);
+        t += 200 + Hal::random32() % 1300;
+    }
+    Hal::sim::schedulePin(pin, level, t);
+}
+
+constexpr uint32_t kMaxBounceMs = 12;
+
+struct PressRun {
+    uint32_t scheduled = 0, holds = 0;
+    uint64_t presses = 0, releases = 0, longs = 0, repeats = 0, repeatsExpected = 0;
+    uint32_t worstLatencyMs = 0, worstStampErrMs = 0, dropped = 0;
+};
+
+// Volumeknop met auto-repeat: 60..150 ms los, 40..120 ms ingedrukt, elke 25e druk 0.7..2 s vast;
+// de taak slaapt tussen gebeurtenissen en is elke 2 s 250 ms bezig zonder pop
+PressRun runPresses(uint64_t seed, uint32_t count) {
+    Hal::sim::reset();
+    Hal::sim::seedRandom(seed);
+    const int pin = Config::PIN_BTN_VOL_UP;
+    Button btn(pin, true, true);
+    btn.begin();
+    WakeScheduler wake;
+
+    const uint32_t kHoldEvery = 25;
+    const uint32_t kStallEveryMs = 2000, kStallMs = 250;
+    PressRun r;
+    uint64_t startUs = 100000;
+    std::vector<uint64_t> pressAtUs;
+    uint32_t nextStallMs = kStallEveryMs;
+    bool stalled = false;
+
+    auto scheduleNext = [&]() {
+        bool hold = (r.scheduled + 1) % kHoldEvery == 0;
+        uint64_t downUs = hold ? 700000 + Hal::random32() % 1300000 : 40000 + Hal::random32() % 80000;
+        scheduleBouncyEdge(pin, LOW, startUs);
+        scheduleBouncyEdge(pin, HIGH, startUs + downUs);
+        pressAtUs.push_back(startUs);
+        if (hold) {
+            ++r.holds;
+            uint64_t heldMs = downUs / 1000;
+            if (heldMs > BTN_LONG_MS) r.repeatsExpected += (heldMs - BTN_LONG_MS - 1) / BTN_REPEAT_MS;
+        }
+        startUs += downUs + 60000 + Hal::random32() % 90000;
+        ++r.scheduled;
+    };
+    auto feed = [&]() {
+        if (r.scheduled < count && Hal::sim::micros64() >= pressAtUs.back()) scheduleNext();
+    };
+    scheduleNext();
+
+    while (r.releases < count && Hal::sim::micros64() < startUs + 5000000) {
+        uint32_t now = Hal::millis();
+        feed();
+        ButtonEvent ev;
+        while (btn.pop(ev)) {
+            switch (ev.kind) {
+            case ButtonEvent::Press: {
+                if (r.presses >= pressAtUs.size()) { ++r.presses; break; }
+                uint64_t at = pressAtUs[r.presses++];
+                uint32_t lat = (uint32_t)((Hal::sim::micros64() - at) / 1000u);
+                uint32_t err = (uint32_t)(ev.ms - (uint32_t)(at / 1000u));
+                if (!stalled && lat > r.worstLatencyMs) r.worstLatencyMs = lat;
+                if (err > r.worstStampErrMs) r.worstStampErrMs = err;
+                break;
+            }
+            case ButtonEvent::Release: ++r.releases; break;
+            case ButtonEvent::LongPress: ++r.longs; break;
+            case ButtonEvent::Repeat: ++r.repeats; break;
+            }
+        }
+        stalled = false;
+        if ((int32_t)(now - nextStallMs) >= 0) {
+            for (uint32_t ms = 0; ms < kStallMs; ++ms) { Hal::delay(1); feed(); }
+            nextStallMs = now + kStallEveryMs;
+            stalled = true;
+            continue;
+        }
+        wake.reset(now);
+        if (r.scheduled < count) wake.request(WakeScheduler::until(now, (uint32_t)(pressAtUs.back() / 1000u) + 1));
+        wake.request(WakeScheduler::until(now, nextStallMs));
+        wake.sleep();
+    }
+    r.dropped = btn.dropped();
+    return r;
+}
+
+// precies één Press en één Release per druk, één LongPress per vastgehouden druk, niets verloren
+void test_every_press_exactly_once() {
+    for (uint64_t seed : { 1ull, 9ull }) {
+        PressRun r = runPresses(seed, 2000);
+        TEST_ASSERT_EQUAL_UINT32(2000, r.scheduled);
+        TEST_ASSERT_EQUAL_UINT32(2000, (uint32_t)r.presses);
+        TEST_ASSERT_EQUAL_UINT32(2000, (uint32_t)r.releases);
+        TEST_ASSERT_EQUAL_UINT32(r.holds, (uint32_t)r.longs);
+        TEST_ASSERT_EQUAL_UINT32(0, r.dropped);
+        // de dender kan een Repeat-tijdstip per vastgehouden druk verschuiven
+        TEST_ASSERT_UINT32_WITHIN(r.holds, (uint32_t)r.repeatsExpected, (uint32_t)r.repeats);
+    }
+}
+
+// tijdstempel op de flank (binnen de dender), en zonder stall snel uit de queue
+void test_press_timing() {
+    PressRun r = runPresses(1, 2000);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(kMaxBounceMs, r.worstStampErrMs);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(kMaxBounceMs + 2, r.worstLatencyMs);
+}
+
+// schone druk: Press en Release met het tijdstip van de flank
+void test_clean_press_stamps() {
+    const int pin = Config::PIN_BTN_NEXT;
+    Button btn(pin, true);
+    btn.begin();
+    Hal::sim::schedulePin(pin, LOW, 10000);
+    Hal::sim::schedulePin(pin, HIGH, 200000);
+    Hal::delay(300);
+    ButtonEvent ev;
+    TEST_ASSERT_TRUE(btn.pop(ev));
+    TEST_ASSERT_EQUAL_INT(ButtonEvent::Press, ev.kind);
+    TEST_ASSERT_EQUAL_UINT32(10, ev.ms);
+    TEST_ASSERT_TRUE(btn.pop(ev));
+    TEST_ASSERT_EQUAL_INT(ButtonEvent::Release, ev.kind);
+    TEST_ASSERT_EQUAL_UINT32(200, ev.ms);
+    TEST_ASSERT_FALSE(btn.pop(ev));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_press_exactly_once);
+    RUN_TEST(test_press_timing);
+    RUN_TEST(test_clean_press_stamps);
+    return UNITY_END();
+}
@@ -0,0 +1,72 @@
+// --- file: test_day/test_main.cpp
+// ProgDay-golf uit WaveTable: tabel + integer-schaling binnen 1 duty-stap van double sin, en de 32-bit
+// fase-accumulator met een drift die alleen uit de afronding van PhaseStep komt (< 1e-2 rad na 100 h).
+#include <unity.h>
+#include <cmath>
+#include "Config.h"
+#include "LightProgram.h"
+#include "WaveTable.h"
+
+void setUp() {}
+void tearDown() {}
+
+const double kTwoPi = 6.283185307179586;
+
+uint32_t maxWaveDiff(uint16_t maxv) {
+    uint32_t maxDiff = 0;
+    for (uint32_t k = 0; k < 65536; ++k) {
+        uint32_t ph = k << 16 | (k * 2654435761u >> 16);   // ook tussen de tabelpunten
+        double x = 0.35 + 0.25 * (0.5 + 0.5 * sin((double)ph / 4294967296.0 * kTwoPi));
+        uint32_t ref = (uint32_t)(x * maxv);
+        uint32_t q = ProgDay::waveDuty(ph, maxv);
+        uint32_t diff = ref > q ? ref - q : q - ref;
+        if (diff > maxDiff) maxDiff = diff;
+    }
+    return maxDiff;
+}
+
+// 8 bits (WS2812), 12 bits (LEDC en PCA9685) en de volle 16 bits
+void test_wave_within_one_step() {
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, maxWaveDiff(255));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, maxWaveDiff((1u << Config::LEDC_RES_BITS) - 1u));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, maxWaveDiff(65535));
+}
+
+// bereik 0.35 .. 0.60 van maxv
+void test_wave_range() {
+    const uint16_t maxv = (1u << Config::LEDC_RES_BITS) - 1u;
+    uint32_t lo = 0xFFFFFFFFu, hi = 0;
+    for (uint32_t k = 0; k < 65536; ++k) {
+        uint32_t d = ProgDay::waveDuty(k << 16, maxv);
+        if (d < lo) lo = d;
+        if (d > hi) hi = d;
+    }
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(0.35 * maxv), lo);
+    TEST_ASSERT_UINT32_WITHIN(1, (uint32_t)(0.60 * maxv), hi);
+}
+
+// fasedrift na 100 h bij 100 Hz t.o.v. de exacte fase: hoogstens een halve fase-eenheid per tick
+// (afronding van PhaseStep), en in de praktijk < 1e-2 rad
+void test_phase_drift_bounded() {
+    const uint64_t ticks = 100ull * 3600 * 100;
+    uint32_t phase = 0;
+    for (uint64_t t = 0; t < ticks; ++t) phase += ProgDay::PhaseStep;
+    double exact = fmod((double)ticks * 0.055, kTwoPi);
+    double got = (double)phase / 4294967296.0 * kTwoPi;
+    double drift = fabs(fmod(got - exact + 3 * kTwoPi / 2, kTwoPi) - kTwoPi / 2);
+    double perTick = fabs((double)ProgDay::PhaseStep / 4294967296.0 * kTwoPi - 0.055);
+    TEST_ASSERT_TRUE(perTick <= 0.5 * kTwoPi / 4294967296.0);
+    TEST_ASSERT_TRUE(drift <= perTick * (double)ticks + 1e-9);
+    TEST_ASSERT_TRUE(drift < 1e-2);
+    // de tweede LED loopt 1.3 rad voor, ook na de wrap
+    double off = (double)ProgDay::PhaseOffset2 / 4294967296.0 * kTwoPi;
+    TEST_ASSERT_TRUE(fabs(off - 1.3) <= 0.5 * kTwoPi / 4294967296.0);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_wave_within_one_step);
+    RUN_TEST(test_wave_range);
+    RUN_TEST(test_phase_drift_bounded);
+    return UNITY_END();
+}
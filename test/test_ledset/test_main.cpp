@@ -0,0 +1,73 @@
+// --- file: test_ledset/test_main.cpp
+// LedSet schaalt in Q16 (één multiply-shift). Over het LEDC-bereik (Config::LEDC_RES_BITS) moet dat
+// binnen 1 duty-stap blijven van de oude float-schaling (w[i] * duty, daarna * overlay), over alle
+// 16 bits binnen 1 stap van het afgekapte exacte product. (Boven 12 bits wijkt de float-schaling zelf
+// tot 2 stappen af: ze kapt twee keer af.)
+#include <unity.h>
+#include <cmath>
+#include "../StormFixture.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+// Oude float-schaling van LedSet::setOneScaledMasked
+uint32_t floatScaled(float w, float overlay, uint16_t duty) {
+    uint32_t d = (uint32_t)(w * duty);
+    d = (uint32_t)(overlay * d);
+    return d > 65535u ? 65535u : d;
+}
+
+void checkWeights(const float* w, int n) {
+    const uint32_t ledcMax = (1u << Config::LEDC_RES_BITS) - 1u;
+    FrameLayer layer(n, 65535);
+    LedSet set(layer, w);
+    for (float ov : { 1.0f, 0.8f, 0.33f, 0.0f }) {
+        set.setOverlay(ov);
+        for (uint32_t d = 0; d <= 65535; ++d) {
+            set.setAllScaledMasked((uint16_t)d);
+            for (int i = 0; i < n; ++i) {
+                if (!(w[i] > 0.0f)) {
+                    TEST_ASSERT_FALSE(layer.owns(i));
+                    continue;
+                }
+                uint32_t q = layer.get(i);
+                if (d <= ledcMax) TEST_ASSERT_UINT32_WITHIN(1, floatScaled(w[i], ov, (uint16_t)d), q);
+                uint32_t exact = (uint32_t)floor((double)w[i] * (double)ov * (double)d);
+                TEST_ASSERT_UINT32_WITHIN(1, exact, q);
+            }
+        }
+    }
+}
+
+void test_config_weights() {
+    checkWeights(Config::LEDSET_THUNDER_WEIGHTS, Config::LED_COUNT);
+    checkWeights(Config::LEDSET_DAY_WEIGHTS, Config::LED_COUNT);
+    checkWeights(Config::LEDSET_BLINK_WEIGHTS, Config::LED_COUNT);
+}
+
+// weights van 0 tot 1 in stappen van 1/64
+void test_weight_sweep() {
+    float w[65];
+    for (int i = 0; i <= 64; ++i) w[i] = i / 64.0f;
+    checkWeights(w, 65);
+}
+
+// w = 1, overlay = 1: Q16-multiplier 65536, de duty gaat ongewijzigd door (geen overloop in 32 bits)
+void test_full_scale_passthrough() {
+    const float one[1] = { 1.0f };
+    FrameLayer layer(1, 65535);
+    LedSet set(layer, one);
+    TEST_ASSERT_EQUAL_UINT32(65536, set.multiplierQ16(0));
+    for (uint32_t d = 0; d <= 65535; ++d) {
+        set.setOneScaledMasked(0, (uint16_t)d);
+        TEST_ASSERT_EQUAL_UINT16(d, layer.get(0));
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_config_weights);
+    RUN_TEST(test_weight_sweep);
+    RUN_TEST(test_full_scale_passthrough);
+    return UNITY_END();
+}
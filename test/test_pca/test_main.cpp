@@ -0,0 +1,116 @@
+// --- file: test_pca/test_main.cpp
+// Pca9685 op de FakeI2cBus: registers volgen de duty's van de kanalen, één burst per bord per frame,
+// en na een mislukte transactie stuurt de volgende flush() het bereik opnieuw.
+#include <unity.h>
+#include "../StormFixture.h"
+#include "Pca9685.h"
+#include "native/FakeI2c.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+constexpr int kBoards = Pca9685::kMaxChips;
+constexpr int kCh = kBoards * Pca9685::kChannelsPerChip;
+
+uint16_t outputDuty(FakeI2cBus& bus, Pca9685& pca, int ch) {
+    return bus.pcaDuty(pca.address(ch / Pca9685::kChannelsPerChip), ch % Pca9685::kChannelsPerChip);
+}
+
+void test_begin_sets_prescale() {
+    FakeI2cBus bus(Config::I2C_FREQ);
+    bus.addPca9685(Config::PCA9685_ADDR);
+    Pca9685 pca(bus, Config::PCA9685_ADDR, 1);
+    TEST_ASSERT_TRUE(pca.begin(Config::PCA9685_PWM_FREQ));
+    TEST_ASSERT_EQUAL_UINT8(Pca9685::prescaleFor(Config::PCA9685_PWM_FREQ), bus.reg(Config::PCA9685_ADDR, Pca9685::kPreScale));
+    TEST_ASSERT_EQUAL_UINT32(0, pca.errors());
+
+    // tweede bord ontbreekt: begin() meldt het
+    Pca9685 two(bus, Config::PCA9685_ADDR, 2);
+    TEST_ASSERT_FALSE(two.begin(Config::PCA9685_PWM_FREQ));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, two.errors());
+}
+
+// 10 min onweer op 64 kanalen (4 borden): na elke commit met I2C staan alle registers op de duty,
+// hoogstens één transactie per bord
+void test_storm_registers_follow_duties() {
+    FakeI2cBus bus(Config::I2C_FREQ);
+    for (int b = 0; b < kBoards; ++b) bus.addPca9685((uint8_t)(Config::PCA9685_ADDR + b));
+    Pca9685 pca(bus, Config::PCA9685_ADDR, kBoards);
+    TEST_ASSERT_TRUE(pca.begin(Config::PCA9685_PWM_FREQ));
+    Fixture::Channels chans(pca, kCh, Config::PCA9685_PWM_FREQ);
+    float weights[kCh];
+    for (int i = 0; i < kCh; ++i) weights[i] = 1.0f - 0.9f * (float)i / (kCh - 1);
+    Fixture::ThunderRig rig(chans, weights, 1);
+    rig.start();
+    bus.resetCounters();
+
+    uint32_t busyFrames = 0;
+    for (uint32_t ms = 0; ms < 10 * 60000u; ++ms) {
+        uint32_t tx0 = bus.transactions();
+        rig.step();
+        uint32_t tx = bus.transactions() - tx0;
+        if (!tx) continue;
+        ++busyFrames;
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32((uint32_t)kBoards, tx);
+        for (int i = 0; i < kCh; ++i) TEST_ASSERT_EQUAL_UINT16(chans[i].duty(), outputDuty(bus, pca, i));
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(0, busyFrames);
+    TEST_ASSERT_EQUAL_UINT32(0, bus.nacks());
+    TEST_ASSERT_EQUAL_UINT32(0, pca.errors());
+    TEST_ASSERT_FALSE(pca.pending());
+}
+
+// mislukte burst: registers ongewijzigd, pending(); een frame later (zonder nieuwe duty's) komt alles
+// alsnog aan, ook een uitgang die in de tussentijd is bijgekomen
+void test_failed_flush_retries() {
+    FakeI2cBus bus(Config::I2C_FREQ);
+    bus.addPca9685(Config::PCA9685_ADDR);
+    Pca9685 pca(bus, Config::PCA9685_ADDR, 1);
+    TEST_ASSERT_TRUE(pca.begin(Config::PCA9685_PWM_FREQ));
+    const int n = Pca9685::kChannelsPerChip;
+    Fixture::Channels chans(pca, n, Config::PCA9685_PWM_FREQ);
+    Compositor frame(chans.data(), n);
+    FrameLayer layer(n, chans[0].maxDuty());
+    frame.addLayer(&layer);
+
+    layer.set(3, 1000);
+    layer.set(7, 2000);
+    bus.failNext(1);
+    frame.commit();
+    TEST_ASSERT_EQUAL_UINT32(1, bus.nacks());
+    TEST_ASSERT_EQUAL_UINT32(1, pca.errors());
+    TEST_ASSERT_EQUAL_UINT16(0, outputDuty(bus, pca, 3));
+    TEST_ASSERT_EQUAL_UINT16(0, outputDuty(bus, pca, 7));
+    TEST_ASSERT_TRUE(pca.pending());
+    TEST_ASSERT_EQUAL_UINT32(1, frame.nextWakeIn(Hal::millis())); // loop wekt om het opnieuw te proberen
+
+    // tweede poging faalt ook, intussen komt uitgang 12 erbij
+    layer.set(12, 500);
+    bus.failNext(1);
+    frame.commit();
+    TEST_ASSERT_EQUAL_UINT32(2, pca.errors());
+    TEST_ASSERT_TRUE(pca.pending());
+
+    // bus weer in orde: één burst met 3..12, geen nieuwe duty's nodig
+    uint32_t tx0 = bus.transactions();
+    frame.commit();
+    TEST_ASSERT_EQUAL_UINT32(1, bus.transactions() - tx0);
+    TEST_ASSERT_EQUAL_UINT16(chans[3].duty(), outputDuty(bus, pca, 3));
+    TEST_ASSERT_EQUAL_UINT16(chans[7].duty(), outputDuty(bus, pca, 7));
+    TEST_ASSERT_EQUAL_UINT16(chans[12].duty(), outputDuty(bus, pca, 12));
+    TEST_ASSERT_TRUE(chans[3].duty() > 0 && chans[7].duty() > 0 && chans[12].duty() > 0);
+    TEST_ASSERT_FALSE(pca.pending());
+
+    // daarna niets meer te sturen
+    tx0 = bus.transactions();
+    frame.commit();
+    TEST_ASSERT_EQUAL_UINT32(0, bus.transactions() - tx0);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_sets_prescale);
+    RUN_TEST(test_storm_registers_follow_duties);
+    RUN_TEST(test_failed_flush_retries);
+    return UNITY_END();
+}
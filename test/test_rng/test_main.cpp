@@ -0,0 +1,75 @@
+// --- file: test_rng/test_main.cpp
+// Rng (xoshiro128** + Lemire): bereik, geen modulo-bias, en reproduceerbare stormen: dezelfde seed
+// geeft bit-identieke kanaal-duty's, een andere seed niet.
+#include <unity.h>
+#include "../StormFixture.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+void test_range_bounds() {
+    Rng rng(0x1234);
+    bool seenLo = false, seenHi = false;
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t v = rng.range(15, 60);
+        TEST_ASSERT_TRUE(v >= 15 && v <= 60);
+        seenLo |= v == 15;
+        seenHi |= v == 60;
+        TEST_ASSERT_LESS_THAN_UINT32(7, rng.below(7));
+        float u = rng.unit();
+        TEST_ASSERT_TRUE(u >= 0.0f && u <= 1.0f);
+    }
+    TEST_ASSERT_TRUE(seenLo && seenHi);
+}
+
+// span 3 * 2^30: met 'random32() % span' valt de helft in het onderste derde, Lemire hoort 1/3 te geven
+void test_no_modulo_bias() {
+    const uint32_t kSpan = 0xC0000000u, kDraws = 3000000;
+    Rng rng(1);
+    uint32_t low = 0;
+    for (uint32_t i = 0; i < kDraws; ++i) low += rng.below(kSpan) < kSpan / 3;
+    double frac = (double)low / kDraws;
+    TEST_ASSERT_TRUE_MESSAGE(frac > 0.33 && frac < 0.337, "onderste derde wijkt af van 1/3");
+}
+
+void test_derived_streams_differ() {
+    Rng a(Rng::derive(42, 0)), b(Rng::derive(42, 1)), c(Rng::derive(42, 0));
+    int same = 0;
+    for (int i = 0; i < 64; ++i) {
+        uint32_t x = a.next();
+        same += x == b.next();
+        TEST_ASSERT_EQUAL_UINT32(x, c.next());
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, same);
+}
+
+// Hash van de kanaal-duty's (elke ms) van een storm; gelijke hash = exact dezelfde storm
+uint64_t stormHash(uint64_t seed, uint32_t minutes) {
+    Hal::sim::reset();
+    Fixture::LedStorm storm(seed);
+    storm.rig.start();
+    uint64_t h = 0xCBF29CE484222325ull; // FNV-1a
+    for (uint32_t ms = 0; ms < minutes * 60000u; ++ms) {
+        storm.rig.step();
+        for (int i = 0; i < Config::LED_COUNT; ++i) {
+            h ^= Hal::sim::pwmDuty(Config::LEDC_CH[i]);
+            h *= 0x100000001B3ull;
+        }
+    }
+    return h;
+}
+
+void test_storm_replays_bit_identical() {
+    uint64_t a = stormHash(7, 10), b = stormHash(7, 10), c = stormHash(8, 10);
+    TEST_ASSERT_TRUE_MESSAGE(a == b, "zelfde seed, andere storm");
+    TEST_ASSERT_TRUE_MESSAGE(a != c, "andere seed, zelfde storm");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_range_bounds);
+    RUN_TEST(test_no_modulo_bias);
+    RUN_TEST(test_derived_streams_differ);
+    RUN_TEST(test_storm_replays_bit_identical);
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+// --- file: test_spsc/test_main.cpp
+// SpscRing: vol/leeg en volgorde in één thread, daarna één producent- en één consumentthread: elk
+// bericht precies één keer, in volgorde en niet gescheurd (ook met de ring telkens vol).
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "SpscRing.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Bericht zoals de opdrachten van main.cpp (8 bytes), met een controlewaarde om scheuren te zien
+struct Msg {
+    uint32_t seq;
+    uint32_t check;
+};
+uint32_t checkOf(uint32_t seq) { return seq * 2654435761u ^ 0xA5A5A5A5u; }
+
+// Wachten op de andere kant: eerst yield, daarna kort slapen (host met 1 core)
+struct Backoff {
+    int n = 0;
+    void pause() {
+        if (++n < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    void reset() { n = 0; }
+};
+
+void test_full_and_empty() {
+    static SpscRing<uint32_t, 16> ring;
+    uint32_t v = 0;
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.pop(v));
+    for (uint32_t i = 0; i < 16; ++i) TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_FALSE(ring.push(99));           // vol: niets overschreven
+    TEST_ASSERT_EQUAL_UINT32(16, ring.size());
+    for (uint32_t i = 0; i < 16; ++i) {
+        TEST_ASSERT_TRUE(ring.pop(v));
+        TEST_ASSERT_EQUAL_UINT32(i, v);
+    }
+    TEST_ASSERT_FALSE(ring.pop(v));
+}
+
+void test_wraps_in_order() {
+    static SpscRing<uint32_t, 4> ring;
+    uint32_t v = 0, expect = 0;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        TEST_ASSERT_TRUE(ring.push(i));
+        if (i % 3 == 2) {                       // afwisselend 1..3 in de ring: de index loopt rond
+            while (ring.pop(v)) TEST_ASSERT_EQUAL_UINT32(expect++, v);
+        }
+    }
+    while (ring.pop(v)) TEST_ASSERT_EQUAL_UINT32(expect++, v);
+    TEST_ASSERT_EQUAL_UINT32(1000, expect);
+}
+
+template <size_t N>
+void runThreads(uint32_t count) {
+    static SpscRing<Msg, N> ring;
+    std::atomic<uint32_t> errors{0}, received{0};
+    std::thread consumer([&] {
+        Backoff wait;
+        uint32_t expect = 0, bad = 0;
+        Msg m;
+        while (expect < count) {
+            if (!ring.pop(m)) { wait.pause(); continue; }
+            wait.reset();
+            if (m.seq != expect || m.check != checkOf(m.seq)) ++bad;
+            ++expect;
+        }
+        errors = bad;
+        received = expect;
+    });
+    Backoff wait;
+    for (uint32_t i = 0; i < count; ++i) {
+        Msg m{ i, checkOf(i) };
+        while (!ring.push(m)) wait.pause();
+        wait.reset();
+    }
+    consumer.join();
+    TEST_ASSERT_EQUAL_UINT32(count, received.load());
+    TEST_ASSERT_EQUAL_UINT32(0, errors.load());
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_threads_render_queue_size() { runThreads<16>(2000000); }   // zoals de render-queue in main.cpp
+void test_threads_large_ring() { runThreads<1024>(2000000); }
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_and_empty);
+    RUN_TEST(test_wraps_in_order);
+    RUN_TEST(test_threads_render_queue_size);
+    RUN_TEST(test_threads_large_ring);
+    return UNITY_END();
+}
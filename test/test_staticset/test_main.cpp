@@ -0,0 +1,44 @@
+// --- file: test_staticset/test_main.cpp
+// StaticLedSet<N, W> moet bit-identiek schrijven aan LedSet met dezelfde weights (elke duty, elke overlay),
+// ook in welke kanalen de laag bezit (masker).
+#include <unity.h>
+#include "../StormFixture.h"
+#include "StaticLedSet.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+template <const float (&W)[Config::LED_COUNT]>
+void checkSameOutput() {
+    const uint16_t maxv = (1u << Config::LEDC_RES_BITS) - 1u;
+    FrameLayer dynLayer(Config::LED_COUNT, maxv), statLayer(Config::LED_COUNT, maxv);
+    LedSet dyn(dynLayer, W);
+    StaticLedSet<Config::LED_COUNT, W> stat(statLayer);
+    for (float ov : { 1.0f, 0.8f, 0.33f, 0.0f }) {
+        dyn.setOverlay(ov);
+        stat.setOverlay(ov);
+        for (uint32_t d = 0; d <= maxv; ++d) {
+            dyn.setAllScaledMasked((uint16_t)d);
+            stat.setAllScaledMasked((uint16_t)d);
+            for (int i = 0; i < Config::LED_COUNT; ++i) {
+                TEST_ASSERT_EQUAL_UINT16(dynLayer.get(i), statLayer.get(i));
+                TEST_ASSERT_EQUAL(dynLayer.owns(i), statLayer.owns(i));
+            }
+            dyn.setOneScaledMasked((int)(d % Config::LED_COUNT), (uint16_t)(maxv - d));
+            stat.setOneScaledMasked((int)(d % Config::LED_COUNT), (uint16_t)(maxv - d));
+            TEST_ASSERT_EQUAL_UINT16(dynLayer.get((int)(d % Config::LED_COUNT)), statLayer.get((int)(d % Config::LED_COUNT)));
+        }
+    }
+}
+
+void test_thunder_weights() { checkSameOutput<Config::LEDSET_THUNDER_WEIGHTS>(); }
+void test_day_weights() { checkSameOutput<Config::LEDSET_DAY_WEIGHTS>(); }
+void test_blink_weights() { checkSameOutput<Config::LEDSET_BLINK_WEIGHTS>(); }
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_thunder_weights);
+    RUN_TEST(test_day_weights);
+    RUN_TEST(test_blink_weights);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+// --- file: test_strike/test_main.cpp
+// StrikeField + ProgThunder: afstandstabellen in vaste stappen t.o.v. het dichtste aangestuurde kanaal,
+// en per subflits vertraging en helderheid die de afstandsvolgorde volgen.
+#include <unity.h>
+#include <algorithm>
+#include <cmath>
+#include "../StormFixture.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+float distance(const Config::LedPos& a, const Config::LedPos& b) {
+    float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+// raster van n kanalen, 5 cm uit elkaar, licht wisselende hoogte
+std::vector<Config::LedPos> grid(int n) {
+    const int cols = (int)ceil(sqrt(n * 4.0 / 3.0));
+    std::vector<Config::LedPos> pos(n);
+    for (int i = 0; i < n; ++i) pos[i] = { (i % cols) * 5.0f, (i / cols) * 5.0f, 20.0f + (i % 3) * 2.0f };
+    return pos;
+}
+
+// per inslagpunt: volgorde van de echte afstand, nul op het dichtste kanaal, vaste 2 cm-stappen
+void test_rows_follow_distance_in_fixed_steps() {
+    const int n = 300;
+    std::vector<Config::LedPos> pos = grid(n);
+    StrikeField field(pos.data(), n);
+    TEST_ASSERT_EQUAL_UINT32((size_t)StrikeField::kOrigins * n, field.tableBytes());
+    std::vector<int> idx(n);
+    for (int o = 0; o < StrikeField::kOrigins; ++o) {
+        std::vector<float> d(n);
+        for (int i = 0; i < n; ++i) d[i] = distance(pos[i], field.origin(o));
+        for (int i = 0; i < n; ++i) idx[i] = i;
+        std::sort(idx.begin(), idx.end(), [&](int a, int b) { return d[a] < d[b]; });
+        TEST_ASSERT_EQUAL_UINT8(0, field.dist(o, idx[0]));
+        for (int k = 1; k < n; ++k) TEST_ASSERT_TRUE(field.dist(o, idx[k]) >= field.dist(o, idx[k - 1]));
+        for (int i = 0; i < n; ++i) {
+            float steps = (d[i] - d[idx[0]]) / StrikeField::kCmPerStep;
+            uint32_t expect = steps >= 255.0f ? 255 : (uint32_t)(steps + 0.5f);
+            TEST_ASSERT_UINT32_WITHIN(1, expect, field.dist(o, i));
+        }
+    }
+}
+
+// Config::LED_POS: LED 3 (knipperlicht, weight 0) mag nulpunt noch schaal bepalen
+void test_weight_zero_channel_ignored() {
+    const StrikeField& field = Fixture::ledField();
+    for (int o = 0; o < StrikeField::kOrigins; ++o) {
+        uint32_t nearest = 255;
+        float dNear = 1e30f;
+        for (int i = 0; i < Config::LED_COUNT; ++i) {
+            if (!(Config::LEDSET_THUNDER_WEIGHTS[i] > 0.0f)) continue;
+            nearest = std::min<uint32_t>(nearest, field.dist(o, i));
+            dNear = std::min(dNear, distance(Config::LED_POS[i], field.origin(o)));
+        }
+        TEST_ASSERT_EQUAL_UINT32(0, nearest);
+        for (int i = 0; i < Config::LED_COUNT; ++i) {
+            float steps = (distance(Config::LED_POS[i], field.origin(o)) - dNear) / StrikeField::kCmPerStep;
+            uint32_t expect = steps <= 0.0f ? 0 : steps >= 255.0f ? 255 : (uint32_t)(steps + 0.5f);
+            TEST_ASSERT_UINT32_WITHIN(1, expect, field.dist(o, i));
+        }
+    }
+}
+
+// storm over het raster: bij elke nieuwe subflits dichterbij = niet later en niet zwakker, en de
+// afzwakking stopt op STRIKE_FALLOFF
+void test_storm_delay_and_gain_follow_distance() {
+    const int n = 120;
+    std::vector<Config::LedPos> pos = grid(n);
+    StrikeField field(pos.data(), n);
+    Fixture::NullPwm out;
+    Fixture::Channels chans(out, n);
+    std::vector<float> weights(n, 1.0f);
+    Fixture::ThunderRig rig(chans, weights.data(), 1, &field);
+    rig.start();
+
+    const uint32_t minGain = 256 - (uint32_t)(Config::STRIKE_FALLOFF * 256.0f + 0.5f);
+    std::vector<int> idx(n);
+    uint32_t subs = 0;
+    uint16_t lastSig[2] = { 0xFFFF, 0xFFFF };
+    for (uint32_t ms = 0; ms < 30 * 60000u; ++ms) {
+        rig.step();
+        const ProgThunder& t = rig.thunder;
+        int o = t.strikeOrigin();
+        for (int i = 0; i < n; ++i) idx[i] = i;
+        std::sort(idx.begin(), idx.end(), [&](int a, int b) { return field.dist(o, a) < field.dist(o, b); });
+        uint16_t sig[2] = { (uint16_t)o, t.channelDelayMs(idx[n - 1]) };
+        if (sig[0] == lastSig[0] && sig[1] == lastSig[1]) continue;
+        lastSig[0] = sig[0];
+        lastSig[1] = sig[1];
+        ++subs;
+        for (int k = 1; k < n; ++k) {
+            TEST_ASSERT_TRUE(t.channelDelayMs(idx[k]) >= t.channelDelayMs(idx[k - 1]));
+            TEST_ASSERT_TRUE(t.channelGainQ8(idx[k]) <= t.channelGainQ8(idx[k - 1]));
+        }
+        TEST_ASSERT_EQUAL_UINT32(256, t.channelGainQ8(idx[0]));
+        for (int i = 0; i < n; ++i) TEST_ASSERT_GREATER_OR_EQUAL_UINT32(minGain, t.channelGainQ8(i));
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(10, subs);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rows_follow_distance_in_fixed_steps);
+    RUN_TEST(test_weight_zero_channel_ignored);
+    RUN_TEST(test_storm_delay_and_gain_follow_distance);
+    return UNITY_END();
+}
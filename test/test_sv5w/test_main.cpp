@@ -0,0 +1,118 @@
+// --- file: test_sv5w/test_main.cpp
+// SV5W-driver tegen de SV5WMock (9600 baud, virtuele klok): geldige antwoorden, herstel na corrupte
+// of afgekapte frames, en geen enkele heap-allocatie tijdens een soak (Response en TX-queue zijn inline).
+#include <unity.h>
+#include <cstdlib>
+#include <new>
+#include "Hal.h"
+#include "Config.h"
+#include "SV5W.h"
+#include "native/SV5WMock.h"
+
+// Heap-teller: elke allocatie in het proces telt mee
+static uint64_t gHeapAllocs = 0;
+void* operator new(size_t n) {
+    ++gHeapAllocs;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+struct QueryProbe {
+    bool done = false;
+    bool valid = false;
+};
+
+void onQuery(const SV5W::Response& r, void* ctx) {
+    QueryProbe* p = (QueryProbe*)ctx;
+    p->done = true;
+    p->valid = r.valid;
+}
+
+struct Soak {
+    uint32_t ok = 0, failed = 0, worstUs = 0;
+    uint64_t allocs = 0;
+};
+
+// queries één voor één, in stappen van 100 us tot het antwoord (of de timeout) er is
+Soak runQueries(SV5W& sv5w, SV5WMock& mock, uint32_t count) {
+    static const SV5W::Command kQueries[] = {
+        SV5W::Command::QUERY_PLAY_STATUS, SV5W::Command::QUERY_VERSION,
+        SV5W::Command::QUERY_NUMBER_OF_SONGS, SV5W::Command::QUERY_CURRENT_SONG,
+        SV5W::Command::QUERY_CURRENT_PLAY_DRIVE, SV5W::Command::QUERY_FOLDER_SONG_COUNT,
+    };
+    Soak s;
+    uint64_t allocsBefore = gHeapAllocs;
+    for (uint32_t q = 0; q < count; ++q) {
+        QueryProbe probe;
+        uint32_t issued = Hal::micros();
+        sv5w.sendQuery(kQueries[q % (sizeof(kQueries) / sizeof(kQueries[0]))], onQuery, &probe);
+        while (!probe.done) {
+            sv5w.poll(Hal::millis());
+            mock.update();
+            if (!probe.done) Hal::sim::advanceMicros(100);
+        }
+        uint32_t rt = Hal::micros() - issued;
+        if (rt > s.worstUs) s.worstUs = rt;
+        probe.valid ? ++s.ok : ++s.failed;
+    }
+    s.allocs = gHeapAllocs - allocsBefore;
+    return s;
+}
+
+// zonder fouten: elk antwoord geldig, ruim binnen de timeout, geen allocaties
+void test_clean_soak() {
+    SV5WMock mock(Config::UART_BAUD, Config::PIN_BUSY);
+    mock.seed(1);
+    SV5W sv5w;
+    sv5w.begin(mock, Config::UART_BAUD);
+    sv5w.setVolume(20);
+    sv5w.playTrack(Config::TRACK_THUNDER);
+
+    Soak s = runQueries(sv5w, mock, 20000);
+    TEST_ASSERT_EQUAL_UINT32(20000, s.ok);
+    TEST_ASSERT_EQUAL_UINT32(0, sv5w.timeouts());
+    TEST_ASSERT_EQUAL_UINT32(0, sv5w.rxErrors());
+    TEST_ASSERT_EQUAL_UINT32(20002, mock.framesReceived());
+    TEST_ASSERT_EQUAL_UINT8(20, mock.volume());
+    TEST_ASSERT_EQUAL_UINT16(Config::TRACK_THUNDER, mock.currentTrack());
+    TEST_ASSERT_LESS_THAN_UINT32(50000, s.worstUs);
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)s.allocs);
+}
+
+// 1% corrupte checksums en 1% afgekapte frames: alleen die queries mislukken (rx-fout of timeout),
+// niets blijft hangen, geen allocaties; daarna zonder fouten weer alles geldig
+void test_faults_recover() {
+    SV5WMock mock(Config::UART_BAUD, Config::PIN_BUSY);
+    mock.seed(3);
+    mock.setCorruptChecksumRate(0.01f);
+    mock.setPartialFrameRate(0.01f);
+    SV5W sv5w;
+    sv5w.begin(mock, Config::UART_BAUD);
+
+    Soak s = runQueries(sv5w, mock, 20000);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, s.failed);
+    TEST_ASSERT_EQUAL_UINT32(s.failed, sv5w.timeouts() + sv5w.rxErrors());
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(mock.corruptedReplies() + mock.partialReplies(), s.failed);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(50000 + 1000, s.worstUs);
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)s.allocs);
+
+    mock.setCorruptChecksumRate(0.0f);
+    mock.setPartialFrameRate(0.0f);
+    Soak after = runQueries(sv5w, mock, 1000);
+    TEST_ASSERT_EQUAL_UINT32(1000, after.ok);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_soak);
+    RUN_TEST(test_faults_recover);
+    return UNITY_END();
+}
@@ -0,0 +1,105 @@
+// --- file: test_trace/test_main.cpp
+// DutyTrace: elke backend schrijft in een eigen kanaalbereik (LEDC-kanaal 0, PCA9685-uitgang 0 en
+// WS2812-pixel 0 zijn verschillende spoorkanalen), het spoor leest terug wat er geschreven is, en
+// een kanaal buiten het formaat telt als dropped in plaats van een ander kanaal te overschrijven.
+#include <vector>
+#include <unity.h>
+#include "../StormFixture.h"
+#include "DutyTrace.h"
+#include "Pca9685.h"
+#include "Ws2812.h"
+#include "native/FakeI2c.h"
+#include "native/RmtSink.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() { LedPwmChannel::setTrace(nullptr); }
+
+using Buffer = std::vector<uint8_t>;
+
+void append(const uint8_t* data, size_t n, void* ctx) {
+    Buffer* b = (Buffer*)ctx;
+    b->insert(b->end(), data, data + n);
+}
+
+std::vector<DutyTrace::Event> readAll(const Buffer& b) {
+    std::vector<DutyTrace::Event> out;
+    DutyTraceReader r(b.data(), b.size());
+    TEST_ASSERT_TRUE(r.valid());
+    DutyTrace::Event e{};
+    while (r.next(e)) out.push_back(e);
+    TEST_ASSERT_TRUE(r.valid());
+    return out;
+}
+
+void test_backends_get_distinct_channels() {
+    FakeI2cBus bus(Config::I2C_FREQ);
+    bus.addPca9685(Config::PCA9685_ADDR);
+    Pca9685 pca(bus, Config::PCA9685_ADDR, 1);
+    TEST_ASSERT_TRUE(pca.begin(Config::PCA9685_PWM_FREQ));
+    RmtSink sink;
+    Ws2812Strip strip(sink, 4);
+
+    Fixture::Channels leds, outs(pca, 1, Config::PCA9685_PWM_FREQ), pixels(strip, 1);
+    Buffer buf;
+    {
+        DutyTraceWriter w(append, &buf);
+        w.begin(7, Hal::millis());
+        LedPwmChannel::setTrace(&w);
+        leds[0].setDuty(100);   leds[0].commit();
+        outs[0].setDuty(200);   outs[0].commit();
+        pixels[0].setDuty(300); pixels[0].commit();
+        LedPwmChannel::setTrace(nullptr);
+        TEST_ASSERT_EQUAL_UINT32(3, w.events());
+        TEST_ASSERT_EQUAL_UINT32(0, w.dropped());
+    }
+    std::vector<DutyTrace::Event> ev = readAll(buf);
+    TEST_ASSERT_EQUAL(3, (int)ev.size());
+    TEST_ASSERT_EQUAL_UINT8(DutyTrace::kBaseLedc + Config::LEDC_CH[0], ev[0].ch);
+    TEST_ASSERT_EQUAL_UINT8(DutyTrace::kBasePca9685, ev[1].ch);
+    TEST_ASSERT_EQUAL_UINT8(DutyTrace::kBaseWs2812, ev[2].ch);
+    TEST_ASSERT_EQUAL_UINT16(100, ev[0].duty);
+    TEST_ASSERT_EQUAL_UINT16(200, ev[1].duty);
+    TEST_ASSERT_EQUAL_UINT16(300, ev[2].duty);
+}
+
+// bereiken overlappen niet: 16 LEDC-kanalen, 4 PCA9685-borden
+void test_ranges_do_not_overlap() {
+    TEST_ASSERT_EQUAL(16, DutyTrace::kBasePca9685 - DutyTrace::kBaseLedc);
+    TEST_ASSERT_EQUAL(Pca9685::kMaxChips * Pca9685::kChannelsPerChip, DutyTrace::kBaseWs2812 - DutyTrace::kBasePca9685);
+    TEST_ASSERT_TRUE(DutyTrace::kBaseWs2812 < DutyTrace::kMaxChannels);
+}
+
+void test_round_trip_and_overflow() {
+    Buffer buf;
+    {
+        DutyTraceWriter w(append, &buf);
+        w.begin(0x123456789ULL, 1000);
+        w.write(1000, 0, 4095);
+        w.write(1003, 255, 1);
+        w.write(1003, 0, 4000);
+        w.write(1010, 256, 5);   // buiten het formaat
+        w.write(1010, -1, 5);
+        w.write(70000, 17, 0);
+        TEST_ASSERT_EQUAL_UINT32(4, w.events());
+        TEST_ASSERT_EQUAL_UINT32(2, w.dropped());
+    }
+    DutyTraceReader r(buf.data(), buf.size());
+    TEST_ASSERT_TRUE(r.valid());
+    TEST_ASSERT_TRUE(r.seed() == 0x123456789ULL);
+    const DutyTrace::Event want[] = { { 1000, 0, 4095 }, { 1003, 255, 1 }, { 1003, 0, 4000 }, { 70000, 17, 0 } };
+    DutyTrace::Event e{};
+    for (const DutyTrace::Event& w : want) {
+        TEST_ASSERT_TRUE(r.next(e));
+        TEST_ASSERT_TRUE(e == w);
+    }
+    TEST_ASSERT_FALSE(r.next(e));
+    TEST_ASSERT_TRUE(r.valid());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_backends_get_distinct_channels);
+    RUN_TEST(test_ranges_do_not_overlap);
+    RUN_TEST(test_round_trip_and_overflow);
+    return UNITY_END();
+}
@@ -0,0 +1,128 @@
+// --- file: test_wake/test_main.cpp
+// Deadline-loop (WakeScheduler + Hal::waitUntil) tegen continu pollen: dezelfde storm, dezelfde
+// knopdrukken, veel minder wakeups.
+#include <unity.h>
+#include "../StormFixture.h"
+#include "StaticLedSet.h"
+#include "BlinkOverlay.h"
+#include "Button.h"
+#include "WakeScheduler.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+struct WakeRun {
+    uint64_t wakeups = 0, flashes = 0, writes = 0;
+    uint32_t bursts = 0, presses = 0, pressesSeen = 0, worstPressMs = 0;
+};
+
+constexpr uint64_t kPressEveryUs = 5ull * 60 * 1000000;
+constexpr uint64_t kPressUs = 120000;
+
+// Storm zoals in main() (thunder + knipper-overlay + NEXT-knop, elke 5 min 120 ms ingedrukt), elke ms
+// pollen of slapen tot de eerstvolgende deadline
+WakeRun runStorm(uint64_t seed, double hours, bool sleep) {
+    Hal::sim::reset();
+    Hal::sim::seedRandom(seed);
+    Fixture::Channels leds;
+    Compositor frame(leds.data(), leds.size());
+    FrameLayer thunderLayer(leds.size(), leds[0].maxDuty());
+    FrameLayer blinkLayer(leds.size(), leds[0].maxDuty());
+    frame.addLayer(&thunderLayer);
+    frame.addLayer(&blinkLayer);
+    LedSet thunderSet(thunderLayer, Config::LEDSET_THUNDER_WEIGHTS);
+    StaticLedSet<Config::LED_COUNT, Config::LEDSET_BLINK_WEIGHTS> blinkSet(blinkLayer);
+    ProgThunder thunder(thunderSet, Config::LEDSET_THUNDER_WEIGHTS, &Fixture::ledField());
+    thunder.seed(Rng::derive(seed, Fixture::kThunderStream));
+    BlinkOverlay blink;
+    Button btn(Config::PIN_BTN_NEXT, true);
+    btn.begin();
+    WakeScheduler wake;
+
+    uint64_t pressAtUs = kPressEveryUs;
+    Hal::sim::schedulePin(Config::PIN_BTN_NEXT, LOW, pressAtUs);
+    Hal::sim::schedulePin(Config::PIN_BTN_NEXT, HIGH, pressAtUs + kPressUs);
+
+    uint32_t now = Hal::millis();
+    thunder.start(now);
+    blink.start(now, 500, 50, 1.0f, 0.0f);
+
+    const int probeCh = Config::LEDC_CH[0];
+    bool wasLit = false;
+    WakeRun r;
+    const uint64_t totalUs = (uint64_t)(hours * 3600.0 * 1000.0) * 1000u;
+    while (Hal::sim::micros64() < totalUs) {
+        now = Hal::millis();
+        ButtonEvent ev;
+        while (btn.pop(ev)) {
+            if (ev.kind != ButtonEvent::Press) continue;
+            uint32_t lat = (uint32_t)((Hal::sim::micros64() - pressAtUs) / 1000u);
+            if (lat > r.worstPressMs) r.worstPressMs = lat;
+            ++r.pressesSeen;
+            pressAtUs += kPressEveryUs;
+            Hal::sim::schedulePin(Config::PIN_BTN_NEXT, LOW, pressAtUs);
+            Hal::sim::schedulePin(Config::PIN_BTN_NEXT, HIGH, pressAtUs + kPressUs);
+        }
+        thunder.update(now);
+        blink.update(now, blinkSet);
+        frame.commit(now);
+
+        bool lit = Hal::sim::pwmDuty(probeCh) > 0;
+        if (lit && !wasLit) ++r.flashes;
+        wasLit = lit;
+
+        if (sleep) {
+            wake.reset(now);
+            wake.request(thunder.nextWakeIn(now));
+            wake.request(blink.nextWakeIn(now));
+            wake.request(frame.nextWakeIn(now));
+            wake.sleep();
+            if (wake.delay() == 0) Hal::sim::advance(1);
+        } else {
+            ++r.wakeups;
+            Hal::sim::advance(1);
+        }
+    }
+    if (sleep) r.wakeups = wake.wakeups();
+    r.bursts = thunder.burstsStarted();
+    r.presses = (uint32_t)((totalUs - 1) / kPressEveryUs);
+    for (int i = 0; i < Config::LED_COUNT; ++i) r.writes += Hal::sim::pwmWrites(Config::LEDC_CH[i]);
+    return r;
+}
+
+// slapen mag niets aan de lichtuitvoer veranderen: zelfde bursts, flitsen en ledcWrites als pollen
+void test_deadlines_match_polling() {
+    for (uint64_t seed : { 1ull, 5ull }) {
+        WakeRun poll = runStorm(seed, 1.0, false);
+        WakeRun ev = runStorm(seed, 1.0, true);
+        TEST_ASSERT_GREATER_THAN_UINT32(0, poll.bursts);
+        TEST_ASSERT_EQUAL_UINT32(poll.bursts, ev.bursts);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)poll.flashes, (uint32_t)ev.flashes);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)poll.writes, (uint32_t)ev.writes);
+    }
+}
+
+// elke druk komt aan, binnen 2 ms na de flank (de timer-callback wekt de loop)
+void test_every_press_seen_promptly() {
+    WakeRun ev = runStorm(1, 2.0, true);
+    TEST_ASSERT_EQUAL_UINT32(23, ev.presses);
+    TEST_ASSERT_EQUAL_UINT32(ev.presses, ev.pressesSeen);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(2, ev.worstPressMs);
+}
+
+// de deadline-loop wekt minstens 10x minder vaak dan pollen op 1 kHz (preglow/nagloei-ramps
+// houden hem elke ms wakker, de rest van de storm slaapt hij tot de volgende gebeurtenis)
+void test_fewer_wakeups_than_polling() {
+    WakeRun poll = runStorm(1, 1.0, false);
+    WakeRun ev = runStorm(1, 1.0, true);
+    TEST_ASSERT_EQUAL_UINT32(3600000u, (uint32_t)poll.wakeups);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32((uint32_t)(poll.wakeups / 10), (uint32_t)ev.wakeups);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_deadlines_match_polling);
+    RUN_TEST(test_every_press_seen_promptly);
+    RUN_TEST(test_fewer_wakeups_than_polling);
+    return UNITY_END();
+}
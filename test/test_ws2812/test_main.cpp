@@ -0,0 +1,112 @@
+// --- file: test_ws2812/test_main.cpp
+// WS2812: pulsvorm en codering, de RmtSink (meet elke puls, decodeert het frame) en een pixel-onweer
+// dat de bursts van het gewone onweer volgt: elk verzonden frame moet de duty's van de pixelkanalen
+// geven, en geen buffer mag veranderen terwijl hij op de draad staat.
+#include <unity.h>
+#include "../StormFixture.h"
+#include "Ws2812.h"
+#include "native/RmtSink.h"
+
+void setUp() { Hal::sim::reset(); }
+void tearDown() {}
+
+void test_pulse_shape() {
+    TEST_ASSERT_EQUAL_UINT32(1250, Ws2812::kBitNs);                       // 800 kHz
+    TEST_ASSERT_EQUAL_UINT32(30, Ws2812::frameUs(3));                     // 24 bits per pixel
+    uint8_t src[2] = { 0x80, 0x01 };
+    uint32_t items[16];
+    size_t used = 0, count = 0;
+    Ws2812::encode(src, 2, items, 16, &used, &count);
+    TEST_ASSERT_EQUAL_UINT32(2, used);
+    TEST_ASSERT_EQUAL_UINT32(16, count);
+    TEST_ASSERT_EQUAL_HEX32(Ws2812::kItem1, items[0]);                    // MSB eerst
+    for (int k = 1; k < 15; ++k) TEST_ASSERT_EQUAL_HEX32(Ws2812::kItem0, items[k]);
+    TEST_ASSERT_EQUAL_HEX32(Ws2812::kItem1, items[15]);
+    // alleen hele bytes: 15 plaatsen is één byte
+    Ws2812::encode(src, 2, items, 15, &used, &count);
+    TEST_ASSERT_EQUAL_UINT32(1, used);
+    TEST_ASSERT_EQUAL_UINT32(8, count);
+}
+
+void test_sink_detects_torn_frame() {
+    RmtSink sink;
+    uint8_t buf[3] = { 1, 2, 3 };
+    TEST_ASSERT_TRUE(sink.send(buf, sizeof buf));
+    buf[1] = 9;                                  // schrijven terwijl hij nog zendt
+    sink.busy();
+    TEST_ASSERT_EQUAL_UINT32(1, sink.tornFrames());
+    TEST_ASSERT_EQUAL_UINT32(0, sink.decodeErrors());
+    TEST_ASSERT_EQUAL_UINT32(0, sink.timingErrors());
+}
+
+void test_rgb_layout_wire_order() {
+    RmtSink sink;
+    Ws2812Strip strip(sink, 2, Ws2812Strip::Layout::Rgb);
+    strip.setup(0, 0, 800000, 8);
+    strip.write(3 + 0, 255);                     // pixel 1 rood
+    strip.write(3 + 2, 128);                     // pixel 1 blauw
+    const uint8_t* f = strip.frame();
+    TEST_ASSERT_EQUAL_UINT8(0, f[3]);            // G
+    TEST_ASSERT_EQUAL_UINT8(255, f[4]);          // R
+    TEST_ASSERT_EQUAL_UINT8(128, f[5]);          // B
+    strip.flush();
+    Hal::sim::advanceMicros(Ws2812::frameUs(6) + Ws2812::kResetUs + 1);
+    TEST_ASSERT_FALSE(sink.busy());
+    TEST_ASSERT_EQUAL_UINT8(255, sink.lastFrame()[4]);
+}
+
+// Pixel-onweer zoals in main.cpp, 10 min: elke verzonden frame = duty x tint van elk pixelkanaal
+void test_follower_storm_frames_match() {
+    const int n = 60;
+    const uint8_t tint[3] = { 190, 200, 255 };
+    const uint8_t tintGrb[3] = { tint[1], tint[0], tint[2] };
+    Fixture::LedStorm storm(3);
+
+    RmtSink sink;
+    Ws2812Strip strip(sink, n, Ws2812Strip::Layout::Mono);
+    strip.setTint(tint[0], tint[1], tint[2]);
+    Fixture::Channels px(strip, n, 800000);
+    std::vector<float> weights(n, 1.0f);
+    Fixture::ThunderRig pixels(px, weights.data(), 3, nullptr, Fixture::kThunderStream + 1);
+    pixels.thunder.setCueSync(true);
+    storm.rig.thunder.setFollower(&pixels.thunder);
+    storm.rig.start();
+    pixels.start();
+
+    const uint32_t maxv = px[0].maxDuty();
+    std::vector<uint8_t> expect(strip.frameBytes());
+    uint32_t sentBefore = 0, mismatches = 0;
+    for (uint32_t ms = 0; ms < 10 * 60000u; ++ms) {
+        uint32_t now = Hal::millis();
+        storm.rig.thunder.update(now);
+        pixels.thunder.update(now);
+        storm.rig.frame.commit(now);
+        pixels.frame.commit(now);
+        if (strip.framesSent() != sentBefore) {
+            sentBefore = strip.framesSent();
+            for (int i = 0; i < n; ++i)
+                for (int c = 0; c < 3; ++c)
+                    expect[i * 3 + c] = (uint8_t)((px[i].duty() * (uint32_t)tintGrb[c] + maxv / 2) / maxv);
+            mismatches += sink.lastFrame() != expect;
+        }
+        Hal::sim::advance(1);
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(1, strip.framesSent());
+    TEST_ASSERT_GREATER_THAN_UINT32(0, storm.rig.thunder.burstsStarted());
+    TEST_ASSERT_EQUAL_UINT32(storm.rig.thunder.burstsStarted(), pixels.thunder.burstsStarted());
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    TEST_ASSERT_EQUAL_UINT32(0, sink.timingErrors());
+    TEST_ASSERT_EQUAL_UINT32(0, sink.decodeErrors());
+    TEST_ASSERT_EQUAL_UINT32(0, sink.tornFrames());
+    TEST_ASSERT_EQUAL_UINT32(0, sink.overruns());
+    TEST_ASSERT_EQUAL_UINT32(0, strip.sendErrors());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pulse_shape);
+    RUN_TEST(test_sink_detects_torn_frame);
+    RUN_TEST(test_rgb_layout_wire_order);
+    RUN_TEST(test_follower_storm_frames_match);
+    return UNITY_END();
+}
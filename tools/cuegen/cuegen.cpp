@@ -0,0 +1,483 @@
+// --- file: cuegen.cpp
+// Host-tool: zoekt de donderklappen in audiotracks en schrijft src/CueData.cpp (formaat: ThunderCues.h).
+// Draait op de PC, niet op de ESP32. Bouwen en draaien vanuit de repo-root:
+//
+//   g++ -std=c++17 -O3 -march=native -fopenmp-simd -pthread tools/cuegen/cuegen.cpp -o cuegen
+//   ./cuegen -o src/CueData.cpp TRACK_THUNDER=audio/0001.wav 4=audio/0004.mp3
+//
+// Invoer: WAV (PCM 16/24/32 bit of float32, elk aantal kanalen) wordt direct gestreamd;
+// andere formaten (MP3, FLAC, ...) gaan via een ffmpeg-pipe (ffmpeg moet in PATH staan).
+// Per track: sleutel = Config-naam (TRACK_THUNDER -> Config::TRACK_THUNDER) of een SV5W-trackindex.
+//
+// Detectie per hop van 10 ms (blokken, geen FFT):
+//  - energie E = mean(x^2) en 'kraak'-energie H = mean((x[i]-x[i-1])^2) (eerste verschil = hoog-doorlaat)
+//  - onset-sterkte = stijging van log(H) t.o.v. het gemiddelde van de vorige ~1,5 s
+//  - drempel = lopend gemiddelde + k * standaardafwijking van die onset-sterkte (adaptief per track)
+//  - intensiteit uit de piek-energie rond de klap t.o.v. de luidste klappen van de track
+//  - subflitsen = aantal losse H-pieken binnen 400 ms na de klap (1..4)
+// De binnenlussen zijn platte float-lussen over aaneengesloten buffers (omp simd -> SSE/AVX/NEON);
+// bestanden worden parallel verwerkt over alle cores.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    const char* out = "src/CueData.cpp";
+    unsigned threads = 0;          // 0 = alle cores
+    float sensitivity = 2.5f;      // k in drempel = mean + k * std
+    uint32_t minGapMs = 700;       // minimale afstand tussen twee cues (één burst duurt ~0,5 s)
+    float floorDb = -30.0f;        // klappen zachter dan dit t.o.v. de luidste worden genegeerd
+    bool dryRun = false;           // alleen rapporteren, niets schrijven
+};
+
+struct Job {
+    std::string key;               // "TRACK_THUNDER" of "4"
+    std::string path;
+};
+
+struct Cue {
+    uint32_t atMs;
+    uint8_t intensity;
+    uint8_t subs;
+};
+
+struct Result {
+    bool ok = false;
+    std::string error;
+    double seconds = 0;            // lengte van de audio
+    std::vector<Cue> cues;
+};
+
+constexpr uint32_t kHopMs = 10;
+constexpr int kHistoryHops = 150;  // 1,5 s context voor de adaptieve drempel
+constexpr int kPeakHops = 30;      // piek-energie zoeken tot 300 ms na de onset
+constexpr int kSubHops = 40;       // subflitsen tellen tot 400 ms na de onset
+
+// ---------------------------------------------------------------------------------------------
+// Decoders: leveren blokken mono float (-1..1) met een vaste sample rate
+// ---------------------------------------------------------------------------------------------
+
+class Source {
+public:
+    virtual ~Source() {}
+    virtual bool open(const std::string& path, std::string& err) = 0;
+    // Vult maximaal 'max' mono samples; 0 = einde
+    virtual size_t read(float* dst, size_t max) = 0;
+    uint32_t rate = 0;
+};
+
+static uint32_t le32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t le16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+class WavSource : public Source {
+public:
+    ~WavSource() override { if (f) fclose(f); }
+
+    bool open(const std::string& path, std::string& err) override {
+        f = fopen(path.c_str(), "rb");
+        if (!f) { err = "kan bestand niet openen"; return false; }
+        uint8_t h[12];
+        if (fread(h, 1, 12, f) != 12 || memcmp(h, "RIFF", 4) || memcmp(h + 8, "WAVE", 4)) {
+            err = "geen RIFF/WAVE";
+            return false;
+        }
+        bool haveFmt = false;
+        for (;;) {
+            uint8_t ch[8];
+            if (fread(ch, 1, 8, f) != 8) { err = "geen data-chunk"; return false; }
+            uint32_t size = le32(ch + 4);
+            if (!memcmp(ch, "fmt ", 4)) {
+                uint8_t fmt[40] = {0};
+                size_t n = size < sizeof(fmt) ? size : sizeof(fmt);
+                if (fread(fmt, 1, n, f) != n) { err = "fmt-chunk afgekapt"; return false; }
+                if (size > n) fseek(f, (long)(size - n), SEEK_CUR);
+                format = le16(fmt);
+                channels = le16(fmt + 2);
+                rate = le32(fmt + 4);
+                bits = le16(fmt + 14);
+                if (format == 0xFFFE && n >= 26) format = le16(fmt + 24); // WAVE_FORMAT_EXTENSIBLE: subformat
+                haveFmt = true;
+            } else if (!memcmp(ch, "data", 4)) {
+                remaining = size;
+                break;
+            } else {
+                fseek(f, (long)(size + (size & 1)), SEEK_CUR); // chunks zijn word-aligned
+            }
+        }
+        if (!haveFmt || channels == 0 || rate == 0) { err = "ongeldige fmt-chunk"; return false; }
+        bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+        bool flt = format == 3 && bits == 32;
+        if (!pcm && !flt) { err = "alleen PCM 16/24/32 bit en float32 worden ondersteund"; return false; }
+        frameBytes = channels * (bits / 8);
+        return true;
+    }
+
+    size_t read(float* dst, size_t max) override {
+        size_t frames = std::min<size_t>(max, remaining / frameBytes);
+        if (frames == 0) return 0;
+        raw.resize(frames * frameBytes);
+        frames = fread(raw.data(), frameBytes, frames, f);
+        remaining -= (uint32_t)(frames * frameBytes);
+
+        // stap 1: alle samples naar float (interleaved), stap 2: kanalen middelen
+        const size_t n = frames * channels;
+        tmp.resize(n);
+        float* t = tmp.data();
+        const uint8_t* r = raw.data();
+        if (format == 3) {
+            memcpy(t, r, n * sizeof(float));
+        } else if (bits == 16) {
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i) t[i] = (float)(int16_t)le16(r + 2 * i) * (1.0f / 32768.0f);
+        } else if (bits == 24) {
+            for (size_t i = 0; i < n; ++i) {
+                const uint8_t* p = r + 3 * i;
+                int32_t v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+                t[i] = (float)v * (1.0f / 8388608.0f);
+            }
+        } else {
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i) t[i] = (float)(int32_t)le32(r + 4 * i) * (1.0f / 2147483648.0f);
+        }
+        if (channels == 1) {
+            memcpy(dst, t, frames * sizeof(float));
+        } else {
+            const float g = 1.0f / channels;
+            for (size_t i = 0; i < frames; ++i) {
+                float s = 0;
+                for (unsigned c = 0; c < channels; ++c) s += t[i * channels + c];
+                dst[i] = s * g;
+            }
+        }
+        return frames;
+    }
+
+private:
+    FILE* f = nullptr;
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t remaining = 0, frameBytes = 1;
+    std::vector<uint8_t> raw;
+    std::vector<float> tmp;
+};
+
+// Alles wat geen WAV is: ffmpeg decodeert naar mono s16le op 22050 Hz (genoeg voor klapdetectie)
+class PipeSource : public Source {
+public:
+    ~PipeSource() override { if (p) pclose(p); }
+
+    bool open(const std::string& path, std::string& err) override {
+        std::string q;
+        for (char c : path) { if (c == '\'') q += "'\\''"; else q += c; }
+        std::string cmd = "ffmpeg -nostdin -v error -i '" + q + "' -f s16le -ac 1 -ar 22050 -";
+        p = popen(cmd.c_str(), "r");
+        if (!p) { err = "kan ffmpeg niet starten"; return false; }
+        rate = 22050;
+        return true;
+    }
+
+    size_t read(float* dst, size_t max) override {
+        raw.resize(max);
+        size_t n = fread(raw.data(), sizeof(int16_t), max, p);
+        const int16_t* r = raw.data();
+        #pragma omp simd
+        for (size_t i = 0; i < n; ++i) dst[i] = (float)r[i] * (1.0f / 32768.0f);
+        return n;
+    }
+
+private:
+    FILE* p = nullptr;
+    std::vector<int16_t> raw;
+};
+
+static bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = strlen(suffix);
+    if (s.size() < n) return false;
+    for (size_t i = 0; i < n; ++i)
+        if (tolower((unsigned char)s[s.size() - n + i]) != suffix[i]) return false;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Features per hop
+// ---------------------------------------------------------------------------------------------
+
+// Som van x^2 en (x[i]-x[i-1])^2 over één hop; prev = laatste sample van de vorige hop
+static inline void hopEnergy(const float* x, size_t n, float prev, float& e, float& h) {
+    float se = 0.0f, sh = 0.0f;
+    float d0 = x[0] - prev;
+    sh = d0 * d0;
+    se = x[0] * x[0];
+    #pragma omp simd reduction(+:se, sh)
+    for (size_t i = 1; i < n; ++i) {
+        float d = x[i] - x[i - 1];
+        se += x[i] * x[i];
+        sh += d * d;
+    }
+    e = se / (float)n;
+    h = sh / (float)n;
+}
+
+// Decodeert de hele track in blokken en levert per hop (10 ms) log-energie en log-kraak-energie
+static bool extractFeatures(Source& src, std::vector<float>& logE, std::vector<float>& logH, double& seconds) {
+    const size_t hop = std::max<size_t>(1, src.rate * kHopMs / 1000);
+    const size_t block = hop * 256;        // ~2,5 s per leesactie
+    std::vector<float> buf(block + hop);   // + rest van de vorige leesactie
+    size_t fill = 0;
+    float prev = 0.0f;
+    uint64_t total = 0;
+
+    for (;;) {
+        size_t got = src.read(buf.data() + fill, block);
+        total += got;
+        fill += got;
+        size_t pos = 0;
+        while (fill - pos >= hop) {
+            float e, h;
+            hopEnergy(buf.data() + pos, hop, prev, e, h);
+            prev = buf[pos + hop - 1];
+            logE.push_back(10.0f * log10f(e + 1e-10f));
+            logH.push_back(10.0f * log10f(h + 1e-10f));
+            pos += hop;
+        }
+        memmove(buf.data(), buf.data() + pos, (fill - pos) * sizeof(float));
+        fill -= pos;
+        if (got == 0) break;
+    }
+    seconds = (double)total / src.rate;
+    return total > 0;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Onset-detectie en cue-opbouw
+// ---------------------------------------------------------------------------------------------
+
+static std::vector<Cue> detect(const std::vector<float>& logE, const std::vector<float>& logH, const Options& opt) {
+    const int n = (int)logH.size();
+    std::vector<Cue> cues;
+    if (n < 2) return cues;
+
+    // onset-sterkte: stijging t.o.v. het lopende gemiddelde van de voorgaande kHistoryHops hops
+    std::vector<float> onset(n, 0.0f);
+    double run = 0.0;
+    for (int t = 0; t < n; ++t) {
+        int k = std::min(t, kHistoryHops);
+        float mean = k ? (float)(run / k) : logH[t];
+        onset[t] = std::max(0.0f, logH[t] - mean);
+        run += logH[t];
+        if (t >= kHistoryHops) run -= logH[t - kHistoryHops];
+    }
+
+    // adaptieve drempel: mean + k*std van de onset-sterkte over hetzelfde venster
+    double s1 = 0.0, s2 = 0.0;
+    const int minGapHops = (int)(opt.minGapMs / kHopMs);
+    int lastHop = -minGapHops;
+    struct Candidate { int hop; float peakE; uint8_t subs; };
+    std::vector<Candidate> found;
+
+    for (int t = 0; t < n; ++t) {
+        int k = std::min(t, kHistoryHops);
+        float mean = k ? (float)(s1 / k) : 0.0f;
+        float var = k ? (float)(s2 / k) - mean * mean : 0.0f;
+        float thr = mean + opt.sensitivity * sqrtf(std::max(var, 0.0f)) + 3.0f; // +3 dB: stilte/ruis negeren
+
+        bool localMax = (t == 0 || onset[t] >= onset[t - 1]) && (t + 1 >= n || onset[t] > onset[t + 1]);
+        if (localMax && onset[t] > thr && t - lastHop >= minGapHops) {
+            Candidate c;
+            c.hop = t;
+            int end = std::min(n, t + kPeakHops);
+            c.peakE = *std::max_element(logE.begin() + t, logE.begin() + end);
+
+            // subflitsen: losse pieken in de kraak-energie die niet meer dan 6 dB onder de eerste liggen
+            int subs = 1;
+            float ref = logH[t];
+            int sEnd = std::min(n - 1, t + kSubHops);
+            for (int i = t + 3; i < sEnd && subs < 4; ++i) {
+                if (logH[i] > logH[i - 1] && logH[i] >= logH[i + 1] && logH[i] > ref - 6.0f &&
+                    logH[i] - std::min(logH[i - 2], logH[i - 3]) > 3.0f) {
+                    ++subs;
+                    i += 3; // minstens 30 ms tussen subflitsen
+                }
+            }
+            c.subs = (uint8_t)subs;
+            found.push_back(c);
+            lastHop = t;
+        }
+
+        s1 += onset[t];
+        s2 += (double)onset[t] * onset[t];
+        if (t >= kHistoryHops) {
+            s1 -= onset[t - kHistoryHops];
+            s2 -= (double)onset[t - kHistoryHops] * onset[t - kHistoryHops];
+        }
+    }
+    if (found.empty()) return cues;
+
+    // intensiteit: piek-energie t.o.v. de luidste klap van de track (0 dB -> 255, floorDb -> 40)
+    float loudest = -1e9f;
+    for (const Candidate& c : found) loudest = std::max(loudest, c.peakE);
+    for (const Candidate& c : found) {
+        float rel = c.peakE - loudest;
+        if (rel < opt.floorDb) continue;
+        float f = 1.0f - rel / opt.floorDb;               // 0..1
+        int v = (int)lroundf(40.0f + f * (255.0f - 40.0f));
+        cues.push_back({ (uint32_t)c.hop * kHopMs, (uint8_t)std::min(v, 255), c.subs });
+    }
+    return cues;
+}
+
+static Result analyse(const Job& job, const Options& opt) {
+    Result r;
+    WavSource wav;
+    PipeSource pipe;
+    Source* src = endsWith(job.path, ".wav") ? (Source*)&wav : (Source*)&pipe;
+    if (!src->open(job.path, r.error)) return r;
+
+    std::vector<float> logE, logH;
+    if (!extractFeatures(*src, logE, logH, r.seconds)) {
+        r.error = "geen audio gedecodeerd";
+        return r;
+    }
+    r.cues = detect(logE, logH, opt);
+    r.ok = true;
+    return r;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Uitvoer: src/CueData.cpp
+// ---------------------------------------------------------------------------------------------
+
+static bool isNumber(const std::string& s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+static std::string arrayName(const std::string& key) {
+    if (isNumber(key)) return "CUES_TRACK_" + key;
+    std::string k = key.compare(0, 6, "TRACK_") == 0 ? key.substr(6) : key;
+    return "CUES_" + k;
+}
+
+static void writeCues(FILE* f, const std::vector<Cue>& cues) {
+    uint32_t last = 0;
+    for (const Cue& c : cues) {
+        uint32_t delta = c.atMs - last;
+        while (delta > 65535u) {                    // gat > 65 s: tussencue zonder flits
+            fprintf(f, "    { 65535,   0, 0 },\n");
+            delta -= 65535u;
+        }
+        fprintf(f, "    { %5u, %3u, %u },  // %u.%03u s\n", delta, c.intensity, c.subs, c.atMs / 1000, c.atMs % 1000);
+        last = c.atMs;
+    }
+}
+
+static bool writeCueData(const char* path, const std::vector<Job>& jobs, const std::vector<Result>& results) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "// --- file: CueData.cpp\n");
+    fprintf(f, "// Cue-tijdlijnen per audiotrack (formaat: zie ThunderCues.h).\n");
+    fprintf(f, "// Gegenereerd door tools/cuegen; opnieuw genereren i.p.v. met de hand aanpassen.\n");
+    fprintf(f, "#include \"ThunderCues.h\"\n#include \"Config.h\"\n");
+
+    std::vector<size_t> written;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (!results[i].ok || results[i].cues.empty()) continue;
+        const std::string& key = jobs[i].key;
+        fprintf(f, "\n// %s%s: %s (%.1f s, %zu cues)\n", isNumber(key) ? "track " : "Config::", key.c_str(),
+                jobs[i].path.c_str(), results[i].seconds, results[i].cues.size());
+        fprintf(f, "static const ThunderCue %s[] = {\n", arrayName(key).c_str());
+        writeCues(f, results[i].cues);
+        fprintf(f, "};\n");
+        written.push_back(i);
+    }
+
+    fprintf(f, "\nstatic const CueTrack CUE_TRACKS[] = {\n");
+    for (size_t i : written) {
+        std::string name = arrayName(jobs[i].key);
+        std::string track = isNumber(jobs[i].key) ? jobs[i].key : "Config::" + jobs[i].key;
+        fprintf(f, "    { %s, sizeof(%s) / sizeof(%s[0]), %s },\n", track.c_str(), name.c_str(), name.c_str(), name.c_str());
+    }
+    if (written.empty()) fprintf(f, "    { 0, 0, nullptr },\n"); // lege array mag niet
+    fprintf(f, "};\n\n");
+    fprintf(f, "const CueTrack* findCueTrack(uint16_t track)\n{\n");
+    fprintf(f, "    for (const CueTrack& t : CUE_TRACKS)\n");
+    fprintf(f, "        if (t.track == track && t.count > 0)\n");
+    fprintf(f, "            return &t;\n");
+    fprintf(f, "    return nullptr;\n}\n");
+    return fclose(f) == 0;
+}
+
+[[noreturn]] static void usage(const char* argv0) {
+    printf("Gebruik: %s [-o src/CueData.cpp] [-j THREADS] [--sensitivity K] [--min-gap MS] [--floor DB] [--dry-run]\n"
+           "          SLEUTEL=bestand [SLEUTEL=bestand ...]\n"
+           "  SLEUTEL: Config-naam (TRACK_THUNDER) of SV5W-trackindex (4)\n", argv0);
+    exit(2);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    std::vector<Job> jobs;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) opt.out = argv[++i];
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc) opt.threads = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--sensitivity") && i + 1 < argc) opt.sensitivity = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "--min-gap") && i + 1 < argc) opt.minGapMs = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--floor") && i + 1 < argc) opt.floorDb = -fabsf((float)atof(argv[++i]));
+        else if (!strcmp(argv[i], "--dry-run")) opt.dryRun = true;
+        else if (const char* eq = strchr(argv[i], '=')) {
+            if (eq == argv[i] || !eq[1]) usage(argv[0]);
+            jobs.push_back({ std::string(argv[i], (size_t)(eq - argv[i])), std::string(eq + 1) });
+        } else usage(argv[0]);
+    }
+    if (jobs.empty()) usage(argv[0]);
+    if (opt.floorDb == 0.0f) opt.floorDb = -30.0f;
+
+    // bestanden parallel: elke worker pakt de volgende job, resultaten blijven in argumentvolgorde
+    std::vector<Result> results(jobs.size());
+    std::atomic<size_t> nextJob(0);
+    unsigned workers = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min<unsigned>(workers, (unsigned)jobs.size());
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < workers; ++w)
+        pool.emplace_back([&] {
+            for (size_t j; (j = nextJob++) < jobs.size();) results[j] = analyse(jobs[j], opt);
+        });
+    for (std::thread& t : pool) t.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    double audio = 0.0;
+    int failed = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const Result& r = results[i];
+        if (!r.ok) {
+            fprintf(stderr, "%s: %s\n", jobs[i].path.c_str(), r.error.c_str());
+            ++failed;
+            continue;
+        }
+        audio += r.seconds;
+        printf("%-16s %-32s %8.1f s  %4zu cues\n", jobs[i].key.c_str(), jobs[i].path.c_str(), r.seconds, r.cues.size());
+    }
+    printf("%.1f s audio in %.2f s (%u threads, %.0fx realtime)\n", audio, wall, workers, wall > 0 ? audio / wall : 0.0);
+
+    if (!opt.dryRun) {
+        if (!writeCueData(opt.out, jobs, results)) {
+            fprintf(stderr, "kan %s niet schrijven\n", opt.out);
+            return 1;
+        }
+        printf("geschreven: %s\n", opt.out);
+    }
+    return failed ? 1 : 0;
+}